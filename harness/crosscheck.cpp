@@ -0,0 +1,220 @@
+// Independent solver used by solve_matrix.sh to cross-check the root score
+// of each board. It shares no code with src/ or src_old/: the board is a
+// plain grid of cells, positions are memoized under a base-3 encoding of the
+// grid, and nothing is pruned by shallow search. Because it explores every
+// position, it can compute exact scores (in the sense of
+// Position::calculate_score) only for small boards. For larger boards it
+// runs an alpha-beta search for the win/draw/loss result instead.
+//
+// Usage: crosscheck COLS ROWS [OPENING]
+//
+// Prints "ROOT SCORE <score>" for boards of up to EXACT_MAX_CELLS cells, and
+// "ROOT RESULT <win|draw|loss>" otherwise, for the player to move after the
+// given opening (a string of column labels as taken by the solver, '1'
+// through '9' then 'a' through 'g'; the empty board by default).
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+constexpr unsigned EXACT_MAX_CELLS = 20;
+
+class Board {
+
+public:
+
+    Board(unsigned num_cols, unsigned num_rows)
+        : cols(num_cols), rows(num_rows),
+          cells(num_cols * num_rows, 0), heights(num_cols, 0),
+          weights(num_cols * num_rows) {
+        std::uint64_t weight = 1;
+        for (unsigned i = 0; i < cols * rows; ++i, weight *= 3) {
+            weights[i] = weight;
+        }
+    }
+
+    unsigned num_cols() const { return cols; }
+
+    bool can_play(unsigned col) const { return heights[col] < rows; }
+
+    bool is_full() const { return num_moves == cols * rows; }
+
+    std::uint64_t key() const { return code; }
+
+    // Returns true if the player to move would complete four in a row by
+    // playing in col.
+    bool wins_with(unsigned col) const {
+        const int player = 1 + static_cast<int>(num_moves % 2);
+        const int c = static_cast<int>(col);
+        const int r = static_cast<int>(heights[col]);
+        static const int directions[4][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}};
+        for (const auto &d : directions) {
+            int count = 1;
+            for (int sign = -1; sign <= 1; sign += 2) {
+                for (int k = 1; k < 4; ++k) {
+                    const int x = c + sign * k * d[0];
+                    const int y = r + sign * k * d[1];
+                    if (!at(x, y, player)) break;
+                    ++count;
+                }
+            }
+            if (count >= 4) return true;
+        }
+        return false;
+    }
+
+    void play(unsigned col) {
+        const unsigned i = col * rows + heights[col]++;
+        cells[i] = static_cast<char>(1 + num_moves % 2);
+        code += cells[i] * weights[i];
+        ++num_moves;
+    }
+
+    void undo(unsigned col) {
+        const unsigned i = col * rows + --heights[col];
+        code -= cells[i] * weights[i];
+        cells[i] = 0;
+        --num_moves;
+    }
+
+private:
+
+    bool at(int x, int y, int player) const {
+        if (x < 0 || y < 0 || x >= static_cast<int>(cols)
+                || y >= static_cast<int>(rows)) {
+            return false;
+        }
+        return cells[static_cast<unsigned>(x) * rows
+                     + static_cast<unsigned>(y)] == player;
+    }
+
+    unsigned cols, rows;
+    std::vector<char> cells;
+    std::vector<unsigned> heights;
+    std::vector<std::uint64_t> weights;
+    std::uint64_t code = 0;
+    unsigned num_moves = 0;
+
+};
+
+// Exact score for the player to move: +d if they win with their d-th move
+// from now counting both players' moves (d odd), -d if they lose on the d-th
+// (d even), and 0 for a draw. A winner picks the fastest win; a loser the
+// slowest loss.
+int exact_score(Board &board, std::unordered_map<std::uint64_t, int> &memo) {
+    const auto found = memo.find(board.key());
+    if (found != memo.end()) return found->second;
+    for (unsigned col = 0; col < board.num_cols(); ++col) {
+        if (board.can_play(col) && board.wins_with(col)) return +1;
+    }
+    int best_negative = 0;
+    int best_positive = 0;
+    bool has_draw = false;
+    for (unsigned col = 0; col < board.num_cols(); ++col) {
+        if (!board.can_play(col)) continue;
+        board.play(col);
+        const int score = exact_score(board, memo);
+        board.undo(col);
+        if (score < 0 && (best_negative == 0 || score > best_negative)) {
+            best_negative = score;
+        } else if (score > best_positive) {
+            best_positive = score;
+        } else if (score == 0) {
+            has_draw = true;
+        }
+    }
+    const int result = best_negative ? 1 - best_negative
+                     : (has_draw || board.is_full()) ? 0
+                     : -best_positive - 1;
+    memo.emplace(board.key(), result);
+    return result;
+}
+
+// Win (+1), draw (0) or loss (-1) for the player to move, by negamax with
+// alpha-beta pruning. Memoized entries record whether the stored value is
+// exact or only a lower or upper bound.
+struct Bound { signed char value, kind; };
+enum : signed char { EXACT, LOWER, UPPER };
+
+int result(Board &board, int alpha, int beta,
+           const std::vector<unsigned> &order,
+           std::unordered_map<std::uint64_t, Bound> &memo) {
+    const int original_alpha = alpha;
+    const auto found = memo.find(board.key());
+    if (found != memo.end()) {
+        const Bound bound = found->second;
+        if (bound.kind == EXACT) return bound.value;
+        if (bound.kind == LOWER && bound.value > alpha) alpha = bound.value;
+        if (bound.kind == UPPER && bound.value < beta) beta = bound.value;
+        if (alpha >= beta) return bound.value;
+    }
+    for (unsigned col = 0; col < board.num_cols(); ++col) {
+        if (board.can_play(col) && board.wins_with(col)) return +1;
+    }
+    if (board.is_full()) return 0;
+    int best = -1;
+    for (const unsigned col : order) {
+        if (best >= beta) break;
+        if (!board.can_play(col)) continue;
+        board.play(col);
+        const int value =
+            -result(board, -beta, -std::max(alpha, best), order, memo);
+        board.undo(col);
+        if (value > best) best = value;
+    }
+    const signed char kind = best <= original_alpha ? UPPER
+                           : best >= beta ? LOWER : EXACT;
+    memo[board.key()] = {static_cast<signed char>(best), kind};
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    if (argc != 3 && argc != 4) {
+        std::cerr << "Usage: " << argv[0] << " COLS ROWS [OPENING]"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    const unsigned cols = static_cast<unsigned>(std::stoul(argv[1]));
+    const unsigned rows = static_cast<unsigned>(std::stoul(argv[2]));
+    Board board(cols, rows);
+    for (const char label : std::string(argc == 4 ? argv[3] : "")) {
+        const unsigned col = ('1' <= label && label <= '9') ? label - '1'
+                           : ('a' <= label && label <= 'g') ? label - 'a' + 9
+                           : cols;
+        if (col >= cols || !board.can_play(col) || board.wins_with(col)) {
+            std::cerr << "Invalid or game-ending move '" << label << "'."
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+        board.play(col);
+    }
+    if (cols * rows <= EXACT_MAX_CELLS) {
+        std::unordered_map<std::uint64_t, int> memo;
+        std::cout << "ROOT SCORE " << exact_score(board, memo) << std::endl;
+    } else {
+        // Central columns are tried first.
+        std::vector<unsigned> order(cols);
+        for (unsigned col = 0; col < cols; ++col) order[col] = col;
+        std::stable_sort(order.begin(), order.end(),
+                         [cols](unsigned a, unsigned b) {
+            return std::abs(2 * static_cast<int>(a) + 1
+                            - static_cast<int>(cols))
+                 < std::abs(2 * static_cast<int>(b) + 1
+                            - static_cast<int>(cols));
+        });
+        std::unordered_map<std::uint64_t, Bound> memo;
+        const int value = result(board, -1, +1, order, memo);
+        std::cout << "ROOT RESULT "
+                  << (value > 0 ? "win" : value < 0 ? "loss" : "draw")
+                  << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
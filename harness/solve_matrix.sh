@@ -0,0 +1,248 @@
+#!/usr/bin/env bash
+#
+# End-to-end correctness and performance harness for src_old/solver.cpp.
+#
+# For each board configuration, this script builds a solver with the board
+# size and search depth overridden on the command line, runs a full solve in
+# a scratch directory, and checks the per-ply position counts and the root
+# score that the solver reports against harness/reference/<config>.txt. The
+# wall time, bytes of I/O and peak RSS of every phase are collected from the
+# solver's PHASE lines into <workdir>/results.tsv, and summarized per config.
+#
+# The reference files were recorded with -r from this solver itself, so they
+# catch regressions but cannot tell whether the solver was right to begin
+# with. The root score is therefore also cross-checked against
+# harness/crosscheck.cpp, an independent brute-force solver: exactly on
+# boards of up to 20 cells, and as a win, draw or loss on larger ones.
+#
+# Boards listed in SUBTREE_OPENINGS below also get subtree solves (solver
+# OPENING) against the tables of the full solve, each cross-checked the same
+# way. They include openings that pass up an immediate win, whose subtrees
+# are missing from the full solve's tables. Finally, WDL tables are derived
+# from the tables of every full solve (src_old/wdlconvert.cpp), and both
+# kinds of table are checked by src_old/verify.cpp.
+#
+# Usage: harness/solve_matrix.sh [options] [CONFIG ...]
+#
+#   CONFIG        COLSxROWS:DEPTH, e.g. 6x4:2 (default: the full matrix below)
+#   -w WORKDIR    scratch directory for binaries and data (default: mktemp)
+#   -b BASELINE   results.tsv from an earlier run; fail if the total wall time
+#                 of any phase (chunkstep, mergestep, endstep or backstep,
+#                 summed over plies) of any config exceeds its baseline by
+#                 more than the tolerance. Phases that took less than 0.1 s
+#                 in the baseline are too noisy to compare and are skipped.
+#   -t TOLERANCE  allowed slowdown factor relative to BASELINE (default: 1.5)
+#   -r            record new reference files instead of checking them
+#
+# The compiler and flags are taken from $CXX and $CXXFLAGS. Any correctness
+# or speed regression makes the script exit with a non-zero status. Boards
+# with more than eight columns are solved with 128-bit keys; adding
+# -DDZC4_WIDE_KEYS to $CXXFLAGS forces 128-bit keys on every board, which
+# must reproduce the same references as the 64-bit build.
+
+set -euo pipefail
+
+DEFAULT_MATRIX=(4x4:1 4x4:2 4x4:3 5x4:2 4x5:2 6x4:1 6x4:2 9x2:2 5x5:2 6x5:2)
+
+# 11333322221 and 3344551 pass up immediate wins, 21433243314 leaves the
+# player to move an immediate win, and the others are reached by a full solve.
+declare -A SUBTREE_OPENINGS=(
+    [4x4]="113 3133 11333322221 21433243314"
+    [6x4]="2 3344551"
+)
+
+repo_dir="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+reference_dir="$repo_dir/harness/reference"
+work_dir=""
+baseline=""
+tolerance="1.5"
+record=0
+
+while getopts "w:b:t:r" opt; do
+    case "$opt" in
+        w) work_dir="$OPTARG" ;;
+        b) baseline="$OPTARG" ;;
+        t) tolerance="$OPTARG" ;;
+        r) record=1 ;;
+        *) sed -n '4,41p' "$0" >&2; exit 2 ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+configs=("$@")
+[ ${#configs[@]} -eq 0 ] && configs=("${DEFAULT_MATRIX[@]}")
+[ -z "$work_dir" ] && work_dir="$(mktemp -d)"
+mkdir -p "$work_dir"
+work_dir="$(cd "$work_dir" && pwd)"
+
+CXX="${CXX:-g++}"
+CXXFLAGS="${CXXFLAGS:--std=c++23 -O3 -march=native}"
+
+results="$work_dir/results.tsv"
+printf 'config\tphase\tply\tseconds\trchar\twchar\tread_bytes\twrite_bytes\tpeak_rss_kb\n' \
+    > "$results"
+
+failures=0
+
+fail() {
+    echo "FAIL: $*" >&2
+    failures=$((failures + 1))
+}
+
+crosscheck="$work_dir/crosscheck"
+# shellcheck disable=SC2086
+"$CXX" $CXXFLAGS -o "$crosscheck" "$repo_dir/harness/crosscheck.cpp"
+declare -A crosscheck_results
+
+# Prints the ROOT SCORE line of a solver log in the form that crosscheck
+# prints for the same board ($2 is crosscheck's output).
+root_in_crosscheck_form() {
+    local score
+    score="$(awk '$1 == "ROOT" { print $3 }' "$1")"
+    case "$2" in
+        "ROOT SCORE "*) echo "ROOT SCORE $score" ;;
+        *) if [ "$score" -gt 0 ]; then echo "ROOT RESULT win"
+           elif [ "$score" -lt 0 ]; then echo "ROOT RESULT loss"
+           else echo "ROOT RESULT draw"; fi ;;
+    esac
+}
+
+# Builds src_old/$1.cpp for the config being checked as $work_dir/$name/$1.
+build_tool() {
+    # shellcheck disable=SC2086
+    "$CXX" $CXXFLAGS -I"$repo_dir/src" \
+        -DDZC4_NUM_COLS="$cols" -DDZC4_NUM_ROWS="$rows" \
+        -DDZC4_DEPTH="$depth" -DDZC4_DATA_DIRECTORY="\"$data_dir/\"" \
+        -o "$work_dir/$name/$1" "$repo_dir/src_old/$1.cpp"
+}
+
+for config in "${configs[@]}"; do
+    if [[ ! "$config" =~ ^([0-9]+)x([0-9]+):([0-9]+)$ ]]; then
+        fail "malformed config '$config' (expected COLSxROWS:DEPTH)"
+        continue
+    fi
+    cols="${BASH_REMATCH[1]}"
+    rows="${BASH_REMATCH[2]}"
+    depth="${BASH_REMATCH[3]}"
+    name="${cols}x${rows}-d${depth}"
+    data_dir="$work_dir/$name/data"
+    binary="$work_dir/$name/solver"
+    log="$work_dir/$name/solver.log"
+
+    echo "=== $name ==="
+    rm -rf "$work_dir/$name"
+    mkdir -p "$data_dir"
+
+    if ! build_tool solver; then
+        fail "$name: build failed"
+        continue
+    fi
+
+    if ! (cd "$data_dir" && "$binary" > "$log" 2>&1); then
+        fail "$name: solver exited with an error (see $log)"
+        continue
+    fi
+
+    awk -v config="$name" 'BEGIN { OFS = "\t" }
+        $1 == "PHASE" {
+            row = config OFS $2 OFS $3
+            for (i = 4; i <= NF; ++i) { split($i, kv, "="); row = row OFS kv[2] }
+            print row
+        }' "$log" >> "$results"
+
+    grep -E '^(PLY|ROOT) ' "$log" | sort -k1,1 -k2,2n > "$work_dir/$name/summary.txt"
+    reference="$reference_dir/$name.txt"
+    if [ "$record" -eq 1 ]; then
+        {
+            echo "# Recorded by solve_matrix.sh -r from src_old/solver.cpp itself;"
+            echo "# the root score is cross-checked against harness/crosscheck.cpp."
+            cat "$work_dir/$name/summary.txt"
+        } > "$reference"
+        echo "Recorded $reference"
+    elif [ ! -f "$reference" ]; then
+        fail "$name: no reference file $reference (run with -r to record one)"
+    elif ! diff -u <(grep -v '^#' "$reference") "$work_dir/$name/summary.txt"; then
+        fail "$name: position counts or root score differ from reference"
+    fi
+
+    board="${cols}x${rows}"
+    if [ -z "${crosscheck_results[$board]:-}" ]; then
+        crosscheck_results[$board]="$("$crosscheck" "$cols" "$rows")"
+    fi
+    expected="${crosscheck_results[$board]}"
+    root_result="$(root_in_crosscheck_form "$work_dir/$name/summary.txt" "$expected")"
+    if [ "$root_result" != "$expected" ]; then
+        fail "$name: solver gives $root_result, but crosscheck gives $expected"
+    fi
+
+    for opening in ${SUBTREE_OPENINGS[$board]:-}; do
+        subtree_log="$work_dir/$name/solver-O$opening.log"
+        if ! (cd "$data_dir" && "$binary" "$opening" > "$subtree_log" 2>&1); then
+            fail "$name: subtree solve of $opening exited with an error (see $subtree_log)"
+            continue
+        fi
+        rm -f "$data_dir"/*"O$opening"*
+        expected="$("$crosscheck" "$cols" "$rows" "$opening")"
+        root_result="$(root_in_crosscheck_form "$subtree_log" "$expected")"
+        if [ "$root_result" != "$expected" ]; then
+            fail "$name: solver gives $root_result below $opening, but crosscheck gives $expected"
+        fi
+    done
+
+    for tool in wdlconvert verify; do
+        if ! build_tool "$tool"; then
+            fail "$name: build of $tool failed"
+        elif ! (cd "$data_dir" && "$work_dir/$name/$tool" \
+                    > "$work_dir/$name/$tool.log" 2>&1); then
+            fail "$name: $tool found problems (see $work_dir/$name/$tool.log)"
+        fi
+    done
+
+    awk -F '\t' -v config="$name" '
+        $1 == config {
+            seconds[$2] += $4; total += $4
+            io[$2] += $5 + $6 + $7 + $8
+            if ($9 > rss[$2]) rss[$2] = $9
+        }
+        END {
+            split("chunkstep mergestep endstep backstep", phases, " ")
+            for (i = 1; i <= 4; ++i) {
+                phase = phases[i]
+                printf "  %-10s %10.2f s %14.0f bytes I/O %10.0f KB peak RSS\n",
+                       phase, seconds[phase], io[phase], rss[phase]
+            }
+            printf "  %-10s %10.2f s\n", "total", total
+        }' "$results"
+
+    if [ -n "$baseline" ]; then
+        verdicts="$(awk -F '\t' -v config="$name" -v tol="$tolerance" '
+            FNR == 1 { next }
+            $1 == config && FILENAME == ARGV[1] { old[$2] += $4; any = 1 }
+            $1 == config && FILENAME == ARGV[2] { new[$2] += $4 }
+            END {
+                if (!any) { print "missing"; exit }
+                for (phase in old) {
+                    if (old[phase] >= 0.1 && new[phase] > tol * old[phase]) {
+                        printf "slow %s %.2f %.2f\n",
+                               phase, new[phase], old[phase]
+                    }
+                }
+            }' "$baseline" "$results")"
+        while read -r verdict phase new old; do
+            case "$verdict" in
+                "") ;;
+                missing) echo "  (no baseline timing for $name)" ;;
+                *) fail "$name: $phase took ${new}s, more than ${tolerance}x the baseline ${old}s" ;;
+            esac
+        done <<< "$verdicts"
+    fi
+
+    rm -rf "$data_dir"
+done
+
+echo "Per-phase results written to $results"
+if [ "$failures" -ne 0 ]; then
+    echo "$failures check(s) FAILED" >&2
+    exit 1
+fi
+echo "All checks passed."
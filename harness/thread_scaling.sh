@@ -0,0 +1,89 @@
+#!/usr/bin/env bash
+#
+# Thread scaling report for the parallel phases of src_old/solver.cpp.
+#
+# For each thread count, this script builds a solver with DZC4_NUM_THREADS
+# overridden on the command line, runs a full solve of one board in a scratch
+# directory, and sums the wall time of its endstep and backstep phases (the
+# only phases that run on the thread pool) from the solver's PHASE lines:
+#
+#     THREADS <n> SECONDS <endstep + backstep> SPEEDUP <relative to first>
+#
+# Usage: harness/thread_scaling.sh [options] [THREADS ...]
+#
+#   THREADS       thread counts to compare (default: 1 2 4 and the number of
+#                 online CPUs)
+#   -c CONFIG     COLSxROWS:DEPTH to solve (default: 6x4:2)
+#   -w WORKDIR    scratch directory for binaries and data (default: mktemp)
+#
+# The compiler and flags are taken from $CXX and $CXXFLAGS. Every run must
+# report the same root score; the script exits with a non-zero status if
+# they differ or any solve fails.
+
+set -euo pipefail
+
+repo_dir="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+config="6x4:2"
+work_dir=""
+
+while getopts "c:w:" opt; do
+    case "$opt" in
+        c) config="$OPTARG" ;;
+        w) work_dir="$OPTARG" ;;
+        *) sed -n '4,21p' "$0" >&2; exit 2 ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+thread_counts=("$@")
+[ ${#thread_counts[@]} -eq 0 ] && thread_counts=(1 2 4 "$(nproc)")
+[ -z "$work_dir" ] && work_dir="$(mktemp -d)"
+mkdir -p "$work_dir"
+work_dir="$(cd "$work_dir" && pwd)"
+
+if [[ ! "$config" =~ ^([0-9]+)x([0-9]+):([0-9]+)$ ]]; then
+    echo "Malformed config '$config' (expected COLSxROWS:DEPTH)" >&2
+    exit 2
+fi
+cols="${BASH_REMATCH[1]}"
+rows="${BASH_REMATCH[2]}"
+depth="${BASH_REMATCH[3]}"
+
+CXX="${CXX:-g++}"
+CXXFLAGS="${CXXFLAGS:--std=c++23 -O3 -march=native}"
+
+echo "=== ${cols}x${rows}-d${depth} on $(nproc) online CPU(s) ==="
+base_seconds=""
+root_scores=""
+for threads in "${thread_counts[@]}"; do
+    data_dir="$work_dir/t$threads/data"
+    binary="$work_dir/t$threads/solver"
+    log="$work_dir/t$threads/solver.log"
+    rm -rf "$work_dir/t$threads"
+    mkdir -p "$data_dir"
+
+    # shellcheck disable=SC2086
+    "$CXX" $CXXFLAGS -I"$repo_dir/src" \
+        -DDZC4_NUM_COLS="$cols" -DDZC4_NUM_ROWS="$rows" \
+        -DDZC4_DEPTH="$depth" -DDZC4_NUM_THREADS="$threads" \
+        -DDZC4_DATA_DIRECTORY="\"$data_dir/\"" \
+        -o "$binary" "$repo_dir/src_old/solver.cpp"
+    (cd "$data_dir" && "$binary" > "$log" 2>&1)
+
+    seconds="$(awk '$1 == "PHASE" && ($2 == "endstep" || $2 == "backstep") {
+                        split($4, kv, "="); total += kv[2]
+                    }
+                    END { printf "%.2f", total }' "$log")"
+    [ -z "$base_seconds" ] && base_seconds="$seconds"
+    awk -v threads="$threads" -v seconds="$seconds" -v base="$base_seconds" \
+        'BEGIN { printf "THREADS %s SECONDS %s SPEEDUP %.2f\n",
+                        threads, seconds, base / seconds }'
+    root_scores+="$(grep '^ROOT ' "$log")"$'\n'
+    rm -rf "$data_dir"
+done
+
+if [ "$(sort -u <<< "$root_scores" | grep -c ROOT)" -ne 1 ]; then
+    echo "Root scores differ between thread counts:" >&2
+    sort -u <<< "$root_scores" >&2
+    exit 1
+fi
@@ -0,0 +1,101 @@
+#ifndef DZC4_BIT_BOARD_HPP_INCLUDED
+#define DZC4_BIT_BOARD_HPP_INCLUDED
+
+#include <bit>     // for std::bit_width
+#include <cstdint> // for std::uint64_t
+
+namespace dzc4 {
+
+
+// BitBoard is a structure that represents the configuration of one player's
+// pieces in a Connect Four board, stored in a single unsigned integer WORD.
+// Each byte of WORD represents one column, so a BitBoard64 (WORD = uint64_t)
+// covers a 7x8 Connect Four board as follows:
+
+//       X  X  X  X  X  X  X  X (MSB)  (All Connect Four boards in comments
+//       6 14 22 30 38 46 54 62         are drawn so that pieces are dropped
+//       5 13 21 29 37 45 53 61         into the board from the top, and
+//       4 12 20 28 36 44 52 60         gravity pulls them toward the bottom.)
+//       3 11 19 27 35 43 51 59
+//       2 10 18 26 34 42 50 58        (A set bit indicates that a piece is
+//       1  9 17 25 33 41 49 57         present; a clear bit represents an
+// (LSB) 0  8 16 24 32 40 48 56         empty space.)
+
+// A BitBoard128 (WORD = unsigned __int128) continues the same layout for
+// columns 8 through 15 in bits 64 through 127, covering a 7x16 board.
+
+// The top bit of every column (7, 15, 23, ...) must NEVER BE SET; these bits
+// must always be zero for the win-checking algorithm employed in won() to
+// work. In particular, they prevent vertical and diagonal four-in-a-row
+// configurations from spilling between columns.
+
+
+template <typename WORD>
+struct BitBoard {
+
+
+    WORD data;
+
+
+    static constexpr unsigned MAX_COLS = sizeof(WORD);
+    static constexpr WORD COLUMN = 0xFF;
+    static constexpr WORD BOTTOM_ROW = ~WORD{0} / COLUMN;
+
+
+    explicit constexpr BitBoard(WORD board) noexcept
+        : data(board) {}
+
+
+    // Returns a mask of the spaces that are playable on a board with the
+    // given dimensions, i.e., those in the bottom NUM_ROWS rows of the
+    // leftmost NUM_COLS columns.
+    template <unsigned NUM_ROWS, unsigned NUM_COLS>
+    static constexpr WORD playable() noexcept {
+        constexpr WORD bit = 1;
+        constexpr WORD rows = BOTTOM_ROW * ((bit << NUM_ROWS) - 1);
+        if constexpr (NUM_COLS < MAX_COLS) {
+            return rows & ((bit << (8 * NUM_COLS)) - 1);
+        } else {
+            return rows;
+        }
+    }
+
+
+    constexpr WORD won() const noexcept {
+        const WORD check_1 = data & (data >> 1);
+        const WORD check_7 = data & (data >> 7);
+        const WORD check_8 = data & (data >> 8);
+        const WORD check_9 = data & (data >> 9);
+        const WORD match_1 = check_1 & (check_1 >> 2);
+        const WORD match_7 = check_7 & (check_7 >> 14);
+        const WORD match_8 = check_8 & (check_8 >> 16);
+        const WORD match_9 = check_9 & (check_9 >> 18);
+        return match_1 | match_7 | match_8 | match_9;
+    }
+
+
+    constexpr unsigned height(unsigned col) const noexcept {
+        const unsigned x = static_cast<unsigned>((data >> (8 * col)) & COLUMN);
+        return static_cast<unsigned>(std::bit_width(x));
+    }
+
+
+    // When this BitBoard holds the pieces of both players, every column is
+    // a contiguous run of set bits starting from the bottom row, so adding one
+    // to each byte yields the lowest empty space of every column at once.
+    // (The top row is always clear, so no carry spills between columns.)
+    constexpr WORD lowest_empty() const noexcept {
+        return data + BOTTOM_ROW;
+    }
+
+
+}; // struct BitBoard
+
+
+using BitBoard64 = BitBoard<std::uint64_t>;
+using BitBoard128 = BitBoard<unsigned __int128>;
+
+
+} // namespace dzc4
+
+#endif // DZC4_BIT_BOARD_HPP_INCLUDED
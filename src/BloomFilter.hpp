@@ -0,0 +1,115 @@
+#ifndef DZC4_BLOOM_FILTER_HPP_INCLUDED
+#define DZC4_BLOOM_FILTER_HPP_INCLUDED
+
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::uint64_t
+
+#include "CompressedPosition.hpp" // for CompressedPosition
+
+namespace dzc4 {
+
+
+// BloomFilter implements a blocked Bloom filter over an array of 64-bit
+// words. Each position is hashed to a single block of BLOCK_WORDS words
+// (one 64-byte cache line), within which NUM_PROBES bits are set, so every
+// query costs at most one cache miss. At BITS_PER_KEY bits per position, the
+// false positive rate is roughly 1%.
+
+// A table file may embed a filter over its positions in its filter section
+// (see TableHeader.hpp). MemoryMappedTable uses it to recognize most
+// positions that are absent from the table without touching any of the
+// table's data pages.
+
+
+struct BloomFilter {
+
+
+    static constexpr std::size_t BLOCK_WORDS = 8;
+    static constexpr std::size_t BLOCK_BITS = 64 * BLOCK_WORDS;
+    static constexpr std::size_t BITS_PER_KEY = 10;
+    static constexpr unsigned NUM_PROBES = 6;
+
+
+    static constexpr std::size_t num_words(std::size_t num_keys) noexcept {
+        const std::size_t num_blocks =
+            (num_keys * BITS_PER_KEY + BLOCK_BITS - 1) / BLOCK_BITS;
+        return BLOCK_WORDS * (num_blocks > 0 ? num_blocks : 1);
+    }
+
+
+    // MurmurHash3 finalizer.
+    static constexpr std::uint64_t mix(std::uint64_t x) noexcept {
+        x ^= x >> 33;
+        x *= 0xFF51AFD7ED558CCD;
+        x ^= x >> 33;
+        x *= 0xC4CEB9FE1A85EC53;
+        x ^= x >> 33;
+        return x;
+    }
+
+
+    static constexpr std::uint64_t hash(std::uint64_t key) noexcept {
+        return mix(key);
+    }
+
+
+    // A 128-bit key mixes its high word into its low word before the final
+    // mix, so that positions differing only in columns 8 through 15 still
+    // hash to different blocks.
+    static constexpr std::uint64_t hash(unsigned __int128 key) noexcept {
+        return mix(static_cast<std::uint64_t>(key) ^
+                   mix(static_cast<std::uint64_t>(key >> 64)));
+    }
+
+
+    // Returns the index of the first word of the block that a position hashes
+    // to, using the high bits of its hash for a multiply-shift reduction. The
+    // probe bits within the block are drawn from the low bits of the hash
+    // after a further multiplication by an odd constant.
+    static constexpr std::size_t
+    block_offset(std::uint64_t hash, std::size_t num_words) noexcept {
+        const std::size_t num_blocks = num_words / BLOCK_WORDS;
+        const auto product = static_cast<unsigned __int128>(hash) * num_blocks;
+        return BLOCK_WORDS * static_cast<std::size_t>(product >> 64);
+    }
+
+
+    template <typename WORD>
+    static void insert(
+        std::uint64_t *words,
+        std::size_t num_words,
+        const CompressedPosition<WORD> &position
+    ) noexcept {
+        const std::uint64_t hash = BloomFilter::hash(position.data);
+        std::uint64_t *block = words + block_offset(hash, num_words);
+        std::uint64_t probes = hash * 0x9E3779B97F4A7C15;
+        for (unsigned i = 0; i < NUM_PROBES; ++i, probes >>= 9) {
+            block[(probes >> 6) % BLOCK_WORDS] |= std::uint64_t{1}
+                                                  << (probes % 64);
+        }
+    }
+
+
+    template <typename WORD>
+    static bool may_contain(
+        const std::uint64_t *words,
+        std::size_t num_words,
+        const CompressedPosition<WORD> &position
+    ) noexcept {
+        const std::uint64_t hash = BloomFilter::hash(position.data);
+        const std::uint64_t *block = words + block_offset(hash, num_words);
+        std::uint64_t probes = hash * 0x9E3779B97F4A7C15;
+        for (unsigned i = 0; i < NUM_PROBES; ++i, probes >>= 9) {
+            const std::uint64_t bit = std::uint64_t{1} << (probes % 64);
+            if (!(block[(probes >> 6) % BLOCK_WORDS] & bit)) { return false; }
+        }
+        return true;
+    }
+
+
+}; // struct BloomFilter
+
+
+} // namespace dzc4
+
+#endif // DZC4_BLOOM_FILTER_HPP_INCLUDED
@@ -0,0 +1,127 @@
+#ifndef DZC4_COMPRESSED_POSITION_HPP_INCLUDED
+#define DZC4_COMPRESSED_POSITION_HPP_INCLUDED
+
+#include <bit>     // for std::bit_width
+#include <compare> // for operator<=>
+#include <cstdint> // for std::uint64_t
+
+#include "BitBoard.hpp" // for BitBoard
+#include "Position.hpp" // for Position
+
+namespace dzc4 {
+
+
+// CompressedPosition is an encoding of a Position in a single WORD, so that a
+// CompressedPosition64 holds a Position128 in 64 bits. Each byte
+// describes one column: the pieces in that column are stored from the bottom
+// up (a set bit for black, a clear bit for white), and are followed by a
+// single set "sentinel" bit marking the column's lowest empty space. Because
+// the sentinel sits exactly where the next piece will land, moves can be
+// played directly in this encoding without decompressing.
+
+
+template <typename WORD>
+struct CompressedPosition {
+
+
+    WORD data;
+
+
+    explicit constexpr CompressedPosition() noexcept
+        : data(BitBoard<WORD>::BOTTOM_ROW) {}
+
+
+    explicit constexpr CompressedPosition(WORD compressed) noexcept
+        : data(compressed) {}
+
+
+    explicit constexpr CompressedPosition(const Position<WORD> &position
+    ) noexcept
+        : data(position.black.data | position.full_board().lowest_empty()) {}
+
+
+    explicit constexpr operator bool() const noexcept {
+        return static_cast<bool>(data);
+    }
+
+
+    constexpr auto
+    operator<=>(const CompressedPosition &) const noexcept = default;
+
+
+    constexpr unsigned offset(unsigned col) const noexcept {
+        const unsigned x =
+            static_cast<unsigned>((data >> (8 * col)) & BitBoard<WORD>::COLUMN);
+        return static_cast<unsigned>(std::bit_width(x)) - 1;
+    }
+
+
+    // Returns a mask with one bit per column, marking the sentinel bit (the
+    // highest set bit) of each byte.
+    constexpr WORD sentinels() const noexcept {
+        constexpr WORD BOTTOM_ROW = BitBoard<WORD>::BOTTOM_ROW;
+        WORD x = data;
+        x |= (x >> 1) & (BOTTOM_ROW * 0x7F);
+        x |= (x >> 2) & (BOTTOM_ROW * 0x3F);
+        x |= (x >> 4) & (BOTTOM_ROW * 0x0F);
+        return x & ~((x >> 1) & (BOTTOM_ROW * 0x7F));
+    }
+
+
+    // Returns a mask with one bit set for each legal move, marking the space
+    // that a piece dropped into that column would occupy. This is the same
+    // mask that Position::moves would return after decompression.
+    template <unsigned NUM_ROWS, unsigned NUM_COLS>
+    constexpr WORD moves() const noexcept {
+        return sentinels() &
+               BitBoard<WORD>::template playable<NUM_ROWS, NUM_COLS>();
+    }
+
+
+    // Plays a piece on the space new_piece, which must be one of the bits
+    // returned by moves(). Adding the sentinel to itself moves it up by one
+    // and leaves a clear (white) bit behind; for black, the old sentinel
+    // stays set and a new sentinel is set above it.
+    template <Player PLAYER>
+    constexpr CompressedPosition play(WORD new_piece) const noexcept {
+        if constexpr (PLAYER == Player::WHITE) {
+            return CompressedPosition(data + new_piece);
+        } else if constexpr (PLAYER == Player::BLACK) {
+            return CompressedPosition(data | (new_piece << 1));
+        } else {
+            static_assert(false);
+        }
+    }
+
+
+    template <Player PLAYER, unsigned NUM_ROWS>
+    constexpr CompressedPosition move(unsigned col) const noexcept {
+        const WORD new_piece =
+            moves<NUM_ROWS, BitBoard<WORD>::MAX_COLS>() &
+            (BitBoard<WORD>::COLUMN << (8 * col));
+        if (new_piece) {
+            return play<PLAYER>(new_piece);
+        } else {
+            return CompressedPosition(0);
+        }
+    }
+
+
+    constexpr Position<WORD> decompress() const noexcept {
+        const WORD mask = sentinels() - BitBoard<WORD>::BOTTOM_ROW;
+        const BitBoard<WORD> white(mask & ~data);
+        const BitBoard<WORD> black(mask & data);
+        return Position<WORD>(white, black);
+    }
+
+
+}; // struct CompressedPosition
+
+
+using CompressedPosition64 = CompressedPosition<std::uint64_t>;
+using CompressedPosition128 = CompressedPosition<unsigned __int128>;
+
+
+} // namespace dzc4
+
+#endif // DZC4_COMPRESSED_POSITION_HPP_INCLUDED
@@ -0,0 +1,71 @@
+#ifndef DZC4_LRU_CACHE_HPP_INCLUDED
+#define DZC4_LRU_CACHE_HPP_INCLUDED
+
+#include <cstddef>       // for std::size_t
+#include <functional>    // for std::hash
+#include <list>          // for std::list
+#include <optional>      // for std::optional
+#include <unordered_map> // for std::unordered_map
+#include <utility>       // for std::pair
+
+namespace dzc4 {
+
+
+// LRUCache maps up to a fixed number of keys to values. Once it is full,
+// inserting a new key evicts the key that was least recently found or
+// inserted. Entries are kept in a list in order of use, with the most
+// recently used one at the front, and indexed by a hash table.
+
+
+template <typename KEY, typename VALUE, typename HASH = std::hash<KEY>>
+class LRUCache {
+
+
+    using Entry = std::pair<KEY, VALUE>;
+    using EntryList = std::list<Entry>;
+
+
+    std::size_t capacity;
+    EntryList entries;
+    std::unordered_map<KEY, typename EntryList::iterator, HASH> index;
+
+
+public:
+
+
+    explicit LRUCache(std::size_t max_entries)
+        : capacity(max_entries) {}
+
+
+    std::size_t size() const noexcept { return entries.size(); }
+
+
+    // Returns the value cached for key, if any, and marks it most recently
+    // used.
+    std::optional<VALUE> find(const KEY &key) {
+        const auto found = index.find(key);
+        if (found == index.end()) { return std::nullopt; }
+        entries.splice(entries.begin(), entries, found->second);
+        return found->second->second;
+    }
+
+
+    // Caches value for key (which must not be cached already), evicting the
+    // least recently used entry if the cache is full.
+    void insert(const KEY &key, const VALUE &value) {
+        if (capacity == 0) { return; }
+        if (entries.size() == capacity) {
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+        entries.emplace_front(key, value);
+        index.emplace(key, entries.begin());
+    }
+
+
+}; // class LRUCache
+
+
+} // namespace dzc4
+
+#endif // DZC4_LRU_CACHE_HPP_INCLUDED
@@ -0,0 +1,77 @@
+#ifndef DZC4_MEMORY_MAPPED_FILE_HPP_INCLUDED
+#define DZC4_MEMORY_MAPPED_FILE_HPP_INCLUDED
+
+#include <cstddef>  // for std::size_t
+#include <iostream> // for std::cerr, std::endl
+
+#include <fcntl.h>    // for UNIX open, O_RDONLY
+#include <sys/mman.h> // for UNIX mmap, munmap, PROT_READ, MAP_SHARED
+#include <sys/stat.h> // for UNIX stat
+#include <unistd.h>   // for UNIX close
+
+#include "Utilities.hpp"
+
+namespace dzc4 {
+
+
+// MemoryMappedFile is an RAII wrapper around a read-only memory mapping of an
+// entire file. It owns both the file descriptor and the mapping, so it can be
+// neither copied nor moved.
+
+
+struct MemoryMappedFile {
+
+
+    std::size_t file_size;
+    int fd;
+    char *data;
+
+
+    explicit MemoryMappedFile(const char *path) {
+        // Use UNIX stat to get size of file.
+        struct stat st;
+        exit_if(
+            stat(path, &st) == -1,
+            "Error occurred while retrieving size of file ",
+            path,
+            "."
+        );
+        file_size = static_cast<std::size_t>(st.st_size);
+        // Use UNIX open to obtain file descriptor.
+        fd = open(path, O_RDONLY);
+        exit_if(fd == -1, "Error occurred while opening file ", path, ".");
+        // Use UNIX mmap to load file into memory.
+        data = static_cast<char *>(
+            mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0)
+        );
+        exit_if(
+            data == MAP_FAILED,
+            "Error occurred while memory-mapping file ",
+            path,
+            "."
+        );
+    }
+
+
+    MemoryMappedFile(const MemoryMappedFile &) = delete;
+    MemoryMappedFile &operator=(const MemoryMappedFile &) = delete;
+
+
+    ~MemoryMappedFile() {
+        if (munmap(data, file_size) == -1) {
+            std::cerr << "Warning: error occurred while unmapping file."
+                      << std::endl;
+        }
+        if (close(fd) == -1) {
+            std::cerr << "Warning: error occurred while closing file."
+                      << std::endl;
+        }
+    }
+
+
+}; // struct MemoryMappedFile
+
+
+} // namespace dzc4
+
+#endif // DZC4_MEMORY_MAPPED_FILE_HPP_INCLUDED
@@ -0,0 +1,107 @@
+#ifndef DZC4_MEMORY_MAPPED_OUTPUT_FILE_HPP_INCLUDED
+#define DZC4_MEMORY_MAPPED_OUTPUT_FILE_HPP_INCLUDED
+
+#include <cstddef>  // for std::size_t
+#include <iostream> // for std::cerr, std::endl
+
+#include <fcntl.h>    // for UNIX open, O_RDWR, O_CREAT, O_TRUNC
+#include <sys/mman.h> // for UNIX mmap, msync, munmap, PROT_WRITE, MS_SYNC
+#include <unistd.h>   // for UNIX close, fsync, ftruncate
+
+#include "Utilities.hpp"
+
+namespace dzc4 {
+
+
+// MemoryMappedOutputFile is the writable counterpart of MemoryMappedFile. It
+// creates (or truncates) a file of a given size and maps all of it for
+// reading and writing, so that disjoint parts of the file can be filled in
+// place, in any order and from any number of threads. Nothing is guaranteed
+// to have reached the disk until sync() returns. A file may be shrunk once
+// its final size is known (see truncate()).
+
+
+struct MemoryMappedOutputFile {
+
+
+    std::size_t file_size;
+    std::size_t map_size;
+    int fd;
+    char *data;
+
+
+    explicit MemoryMappedOutputFile(const char *path, std::size_t size)
+        : file_size(size)
+        , map_size(size)
+        , data(nullptr) {
+        // Use UNIX open and ftruncate to create a zero-filled file.
+        fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        exit_if(fd == -1, "Error occurred while creating file ", path, ".");
+        exit_if(
+            ftruncate(fd, static_cast<off_t>(file_size)) == -1,
+            "Error occurred while resizing file ",
+            path,
+            "."
+        );
+        // An empty file cannot be mapped, but also has nothing to write.
+        if (file_size == 0) { return; }
+        data = static_cast<char *>(mmap(
+            nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0
+        ));
+        exit_if(
+            data == MAP_FAILED,
+            "Error occurred while memory-mapping file ",
+            path,
+            "."
+        );
+    }
+
+
+    MemoryMappedOutputFile(const MemoryMappedOutputFile &) = delete;
+    MemoryMappedOutputFile &operator=(const MemoryMappedOutputFile &) = delete;
+
+
+    ~MemoryMappedOutputFile() {
+        if (data && munmap(data, map_size) == -1) {
+            std::cerr << "Warning: error occurred while unmapping file."
+                      << std::endl;
+        }
+        if (close(fd) == -1) {
+            std::cerr << "Warning: error occurred while closing file."
+                      << std::endl;
+        }
+    }
+
+
+    // Shrinks the file to the given size. The mapping keeps its original
+    // size, but only its first new_size bytes remain backed by the file, and
+    // nothing beyond them may be touched afterwards.
+    void truncate(std::size_t new_size) {
+        exit_if(
+            new_size > file_size,
+            "ERROR: Cannot grow a memory-mapped file by truncating it."
+        );
+        exit_if(
+            ftruncate(fd, static_cast<off_t>(new_size)) == -1,
+            "Error occurred while truncating memory-mapped file."
+        );
+        file_size = new_size;
+    }
+
+
+    // Flushes the mapped contents and the file's metadata to disk.
+    void sync() const {
+        exit_if(
+            data && msync(data, file_size, MS_SYNC) == -1,
+            "Error occurred while flushing memory-mapped file."
+        );
+        exit_if(fsync(fd) == -1, "Error occurred while flushing file.");
+    }
+
+
+}; // struct MemoryMappedOutputFile
+
+
+} // namespace dzc4
+
+#endif // DZC4_MEMORY_MAPPED_OUTPUT_FILE_HPP_INCLUDED
@@ -1,126 +1,619 @@
 #ifndef DZC4_MEMORY_MAPPED_TABLE_HPP_INCLUDED
 #define DZC4_MEMORY_MAPPED_TABLE_HPP_INCLUDED
 
-#include <algorithm> // for std::max
-#include <climits>   // for INT_MIN
-#include <cstddef>   // for std::size_t
-#include <iostream>  // for std::cerr, std::endl
-#include <string>    // for std::string
-
-#include <fcntl.h>    // for UNIX open, O_RDONLY
-#include <sys/mman.h> // for UNIX mmap, munmap, PROT_READ, MAP_SHARED
-#include <sys/stat.h> // for UNIX stat
-#include <unistd.h>   // for UNIX close
-
-#include "CompressedPosition64.hpp"
-#include "Position128.hpp"
+#include <algorithm>  // for std::max, std::min
+#include <climits>    // for INT_MIN
+#include <cstddef>    // for std::size_t
+#include <cstdint>    // for std::uint64_t
+#include <cstring>    // for std::memcpy
+#include <optional>   // for std::optional
+#include <string>     // for std::string
+
+#include "BitBoard.hpp"
+#include "BloomFilter.hpp"
+#include "CompressedPosition.hpp"
+#include "MemoryMappedFile.hpp"
+#include "Position.hpp"
+#include "TableHeader.hpp"
 #include "Utilities.hpp"
+#include "Varint.hpp"
 
 namespace dzc4 {
 
 
+// The data section of a distance table (see TableHeader.hpp) is a sorted
+// array of (CompressedPosition, score) entries, each occupying ENTRY_SIZE
+// bytes, where the score is stored in a single signed byte. The key width
+// (8 or 16 bytes) is fixed by the WORD that a MemoryMappedTable is
+// instantiated with, and must match the key size recorded in the header.
+
+// The data section of a WDL table carries the same sorted positions with
+// each score reduced to a 2-bit Evaluation code, and delta-codes the
+// positions in blocks of WDL_BLOCK_SIZE consecutive entries:
+//
+//     index    for each block, its first position (POSITION_SIZE bytes) and
+//              the offset of the rest of the block in the payload (8 bytes)
+//     codes    ceil(num_entries / 4) bytes of codes packed four to a byte,
+//              least significant bits first
+//     payload  for each block, the difference from each of its positions
+//              to the next, as varints (see Varint.hpp)
+//
+// A lookup binary searches the index for the only block that may hold a
+// position, and then decodes at most WDL_BLOCK_SIZE - 1 differences. The
+// differences between neighbouring positions are small: on the 6x4 board
+// (64-bit keys), the WDL tables of a full solve take 68 MB for 32.7 million
+// entries, or 2.1 bytes per entry, where the distance tables take 9 bytes
+// per entry (and storing each key in full would take 8.25).
+
+// Either kind of table may embed a Bloom filter section (see BloomFilter.hpp),
+// which lets lookups of absent positions skip the binary search. A distance
+// table may also lack a header altogether (see TableHeader.hpp), in which
+// case it has no filter; a WDL table must always have one.
+
+// Callers that evaluate many positions in sorted order (like backstep) should
+// pass the same LookupCursor to each call of evaluate. The children that two
+// nearby parents reach by playing in the same column are themselves near each
+// other in the table, so the cursor remembers where the last lookup for each
+// column landed, and the next one gallops outwards from there (see
+// find_near) instead of searching the whole table again.
+
+
+template <typename WORD>
 struct MemoryMappedTable {
 
 
-    static constexpr std::size_t POSITION_SIZE = sizeof(CompressedPosition64);
-    static constexpr std::size_t ENTRY_SIZE = sizeof(CompressedPosition64) + 1;
+    using Key = CompressedPosition<WORD>;
 
 
-    std::size_t file_size;
+    static constexpr std::size_t POSITION_SIZE = sizeof(Key);
+    static constexpr std::size_t ENTRY_SIZE = sizeof(Key) + 1;
+    static constexpr std::size_t WDL_BLOCK_SIZE = 64;
+    static constexpr std::size_t WDL_INDEX_ENTRY_SIZE = sizeof(Key) + 8;
+
+
+    struct LookupCursor {
+        std::size_t hints[BitBoard<WORD>::MAX_COLS] = {};
+    };
+
+
+    std::optional<MemoryMappedFile> table_file;
+    std::optional<MemoryMappedFile> wdl_file;
+    std::optional<TableHeader> table_header;
+    std::optional<TableHeader> wdl_header;
+    std::string table_path;
+    std::string wdl_path;
+    const char *entries;
+    const char *wdl_entries;
+    const char *wdl_codes;
+    const unsigned char *wdl_payload;
+    std::size_t wdl_payload_size;
+    const std::uint64_t *filter_words;
     std::size_t num_entries;
-    int fd;
-    char *data;
+    std::size_t num_wdl_entries;
+    std::size_t num_filter_words;
+
 
+    explicit MemoryMappedTable(const char *path)
+        : entries(nullptr)
+        , wdl_entries(nullptr)
+        , wdl_codes(nullptr)
+        , wdl_payload(nullptr)
+        , wdl_payload_size(0)
+        , filter_words(nullptr)
+        , num_entries(0)
+        , num_wdl_entries(0)
+        , num_filter_words(0) {
+        open_table(path);
+    }
 
-    explicit MemoryMappedTable(const char *path) {
-        // Use UNIX stat to get size of table file.
-        struct stat st;
+
+    explicit MemoryMappedTable(const std::string &path)
+        : MemoryMappedTable(path.c_str()) {}
+
+
+    // Either path may be empty, in which case the corresponding file is not
+    // opened. lookup_wdl prefers the WDL table, so the distance table can be
+    // left out entirely (or at least left cold) by callers that only need
+    // win/draw/loss information.
+    explicit MemoryMappedTable(
+        const std::string &path, const std::string &wdl_table_path
+    )
+        : entries(nullptr)
+        , wdl_entries(nullptr)
+        , wdl_codes(nullptr)
+        , wdl_payload(nullptr)
+        , wdl_payload_size(0)
+        , filter_words(nullptr)
+        , num_entries(0)
+        , num_wdl_entries(0)
+        , num_filter_words(0) {
+        if (!path.empty()) { open_table(path.c_str()); }
+        if (!wdl_table_path.empty()) {
+            open_wdl_table(wdl_table_path.c_str());
+        }
+    }
+
+
+    // Reads and validates the header of a table file, if it has one, and
+    // checks that it describes a table of the given encoding whose keys fit
+    // in a Key. Opening a table never reads more than its header and its
+    // first and last entries, which are checked against the recorded range.
+    static std::optional<TableHeader> open_header(
+        const char *path,
+        const MemoryMappedFile &file,
+        TableEncoding expected_encoding,
+        bool is_valid_data_size(std::size_t, std::uint64_t)
+    ) {
+        if (!TableHeader::is_present(file.data, file.file_size)) { return {}; }
+        const TableHeader header =
+            TableHeader::read(path, file.data, file.file_size);
         exit_if(
-            stat(path, &st) == -1,
-            "Error occurred while retrieving size of table file ",
+            header.encoding != expected_encoding,
+            "ERROR: Table file ",
             path,
-            "."
+            " has the wrong encoding."
         );
-        // Save file size to member variables.
-        file_size = static_cast<std::size_t>(st.st_size);
-        num_entries = file_size / ENTRY_SIZE;
-        // Use UNIX open to obtain file descriptor for table file.
-        fd = open(path, O_RDONLY);
         exit_if(
-            fd == -1, "Error occurred while opening table file ", path, "."
+            header.key_size != POSITION_SIZE,
+            "ERROR: Table file ",
+            path,
+            " has ",
+            header.key_size,
+            "-byte keys (expected ",
+            POSITION_SIZE,
+            ")."
         );
-        // Use UNIX mmap to load table file into memory.
-        data = static_cast<char *>(
-            mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0)
+        exit_if(
+            !is_valid_data_size(header.num_entries, header.data_size),
+            "ERROR: Table file ",
+            path,
+            " is malformed."
         );
+        return header;
+    }
+
+
+    // Checks the first and last positions of a table, as returned by
+    // get_position(index), against the range recorded in its header.
+    template <typename GET_POSITION>
+    static void check_range(
+        const char *path,
+        const TableHeader &header,
+        const GET_POSITION &get_position
+    ) {
+        if (header.num_entries == 0) { return; }
+        const Key first = get_position(0);
+        const Key last = get_position(header.num_entries - 1);
         exit_if(
-            data == MAP_FAILED,
-            "Error occurred while memory-mapping table file ",
+            (first.data != TableHeader::load_key<WORD>(header.min_key)) ||
+                (last.data != TableHeader::load_key<WORD>(header.max_key)),
+            "ERROR: Table file ",
             path,
-            "."
+            " does not match its recorded key range."
         );
     }
 
 
-    explicit MemoryMappedTable(const std::string &path)
-        : MemoryMappedTable(path.c_str()) {}
+    static constexpr bool is_valid_table_data_size(
+        std::size_t count, std::uint64_t size
+    ) noexcept {
+        return size == ENTRY_SIZE * count;
+    }
+
+
+    void open_table(const char *path) {
+        table_path = path;
+        table_file.emplace(path);
+        table_header = open_header(
+            path, *table_file, TableEncoding::DISTANCE,
+            is_valid_table_data_size
+        );
+        if (table_header) {
+            entries = table_file->data + table_header->data_offset;
+            num_entries = table_header->num_entries;
+            check_range(path, *table_header, [this](std::size_t index) {
+                return get_position(index);
+            });
+            open_embedded_filter(*table_file, *table_header);
+        } else {
+            exit_if(
+                table_file->file_size % ENTRY_SIZE != 0,
+                "ERROR: Table file ",
+                path,
+                " is malformed."
+            );
+            entries = table_file->data;
+            num_entries = table_file->file_size / ENTRY_SIZE;
+        }
+    }
+
+
+    static constexpr std::size_t wdl_num_blocks(std::size_t count) noexcept {
+        return (count + WDL_BLOCK_SIZE - 1) / WDL_BLOCK_SIZE;
+    }
+
+
+    // Returns the size of the index and codes of a WDL table of count
+    // entries, which is where its payload starts.
+    static constexpr std::size_t wdl_payload_offset(
+        std::size_t count
+    ) noexcept {
+        return WDL_INDEX_ENTRY_SIZE * wdl_num_blocks(count) + (count + 3) / 4;
+    }
+
+
+    // The first entry of each block takes no space in the payload, and each
+    // other entry takes at least one byte and at most MAX_VARINT_SIZE bytes.
+    static constexpr bool is_valid_wdl_data_size(
+        std::size_t count, std::uint64_t size
+    ) noexcept {
+        const std::size_t num_deltas = count - wdl_num_blocks(count);
+        return (size >= wdl_payload_offset(count) + num_deltas) &&
+               (size <= wdl_payload_offset(count) +
+                            MAX_VARINT_SIZE<WORD> * num_deltas);
+    }
+
 
+    void open_wdl_table(const char *path) {
+        wdl_path = path;
+        wdl_file.emplace(path);
+        wdl_header = open_header(
+            path, *wdl_file, TableEncoding::WDL, is_valid_wdl_data_size
+        );
+        exit_if(
+            !wdl_header,
+            "ERROR: WDL table file ",
+            path,
+            " has no header."
+        );
+        wdl_entries = wdl_file->data + wdl_header->data_offset;
+        num_wdl_entries = wdl_header->num_entries;
+        const std::size_t num_blocks = wdl_num_blocks(num_wdl_entries);
+        const std::size_t payload_offset = wdl_payload_offset(num_wdl_entries);
+        wdl_codes = wdl_entries + WDL_INDEX_ENTRY_SIZE * num_blocks;
+        wdl_payload = static_cast<const unsigned char *>(
+            static_cast<const void *>(wdl_entries + payload_offset)
+        );
+        wdl_payload_size = wdl_header->data_size - payload_offset;
+        check_range(path, *wdl_header, [this](std::size_t index) {
+            return get_wdl_position(index);
+        });
+        open_embedded_filter(*wdl_file, *wdl_header);
+    }
+
+
+    // Uses the Bloom filter section of a table with a header, if it has one
+    // and no filter has been loaded yet. (A WDL table has the same positions
+    // as the distance table it was derived from, so one filter serves both.)
+    void open_embedded_filter(
+        const MemoryMappedFile &file, const TableHeader &header
+    ) {
+        if (filter_words || (header.filter_size == 0)) { return; }
+        exit_if(
+            header.filter_size % (8 * BloomFilter::BLOCK_WORDS) != 0,
+            "ERROR: Table file has a malformed Bloom filter section."
+        );
+        filter_words = static_cast<const std::uint64_t *>(
+            static_cast<const void *>(file.data + header.filter_offset)
+        );
+        num_filter_words = header.filter_size / 8;
+    }
 
-    ~MemoryMappedTable() {
-        if (munmap(data, file_size) == -1) {
-            std::cerr << "Warning: error occurred while unmapping table file."
-                      << std::endl;
+
+    // Exits with an error if any open table with a header was built for a
+    // different board, ply or search depth. (Tables without a header cannot
+    // be checked, and are trusted to match.)
+    void expect(
+        unsigned num_rows, unsigned num_cols, unsigned ply, unsigned depth
+    ) const {
+        if (table_header) {
+            table_header->expect(
+                table_path.c_str(), num_rows, num_cols, ply, depth
+            );
         }
-        if (close(fd) == -1) {
-            std::cerr << "Warning: error occurred while closing table file."
-                      << std::endl;
+        if (wdl_header) {
+            wdl_header->expect(
+                wdl_path.c_str(), num_rows, num_cols, ply, depth
+            );
         }
     }
 
 
-    CompressedPosition64 get_position(std::size_t index) {
-        return *static_cast<CompressedPosition64 *>(
-            static_cast<void *>(data + ENTRY_SIZE * index)
+    // Recomputes the body checksum of every open table with a header. This
+    // reads each table in full, so it is not done when a table is opened.
+    bool verify_checksum() const {
+        const auto verify = [](const MemoryMappedFile &file,
+                               const TableHeader &header) {
+            return table_checksum(
+                       file.data + TABLE_HEADER_SIZE,
+                       file.file_size - TABLE_HEADER_SIZE
+                   ) == header.body_checksum;
+        };
+        return (!table_header || verify(*table_file, *table_header)) &&
+               (!wdl_header || verify(*wdl_file, *wdl_header));
+    }
+
+
+    // Returns false only if position is certainly absent from the table.
+    bool may_contain(const Key &position) const noexcept {
+        if (!filter_words) { return true; }
+        return BloomFilter::may_contain(
+            filter_words, num_filter_words, position
         );
     }
 
 
-    int get_score(std::size_t index) {
-        return static_cast<int>(*static_cast<signed char *>(
-            static_cast<void *>(data + ENTRY_SIZE * index + POSITION_SIZE)
-        ));
+    static Key load_position(const char *ptr) noexcept {
+        Key result;
+        std::memcpy(&result.data, ptr, POSITION_SIZE);
+        return result;
     }
 
 
-    template <
-        Player PLAYER,
-        unsigned NUM_ROWS,
-        unsigned NUM_COLS,
-        unsigned DEPTH>
-    int lookup_score(const Position128 &position) {
-        const CompressedPosition64 compressed(position);
+    // Returns the index of key in a sorted array of count positions spaced
+    // stride bytes apart, or count if key is not present.
+    static std::size_t find(
+        const char *base,
+        std::size_t stride,
+        std::size_t count,
+        const Key &key
+    ) noexcept {
         std::size_t lower_index = 0;
-        std::size_t upper_index = num_entries - 1;
-        while (true) {
-            if (lower_index > upper_index) {
-                const int score =
-                    position
-                        .calculate_score<PLAYER, NUM_ROWS, NUM_COLS, DEPTH + 1>(
-                        );
-                exit_if(score == INT_MIN, "ERROR: Inconclusive search.");
-                return score;
+        std::size_t upper_index = count;
+        while (lower_index < upper_index) {
+            const std::size_t middle_index =
+                lower_index + (upper_index - lower_index) / 2;
+            const Key center =
+                load_position(base + stride * middle_index);
+            if (center < key) {
+                lower_index = middle_index + 1;
+            } else if (center > key) {
+                upper_index = middle_index;
+            } else {
+                return middle_index;
+            }
+        }
+        return count;
+    }
+
+
+    // Same as find(), but starts from the index hint, doubling its step away
+    // from it until key is bracketed, and only then switches to a binary
+    // search. This takes O(log d) probes when key lies d entries away from
+    // hint. On return, hint holds the index where key is or would be.
+    static std::size_t find_near(
+        const char *base,
+        std::size_t stride,
+        std::size_t count,
+        const Key &key,
+        std::size_t &hint
+    ) noexcept {
+        if (count == 0) { return count; }
+        const std::size_t start = std::min(hint, count - 1);
+        const Key at_start = load_position(base + stride * start);
+        if (at_start == key) {
+            hint = start;
+            return start;
+        }
+        // Bracket the first entry not less than key in [lower, upper].
+        std::size_t lower_index = 0;
+        std::size_t upper_index = count;
+        if (at_start < key) {
+            lower_index = start + 1;
+            for (std::size_t step = 1; start + step < count; step *= 2) {
+                const std::size_t probe = start + step;
+                if (!(load_position(base + stride * probe) < key)) {
+                    upper_index = probe;
+                    break;
+                }
+                lower_index = probe + 1;
             }
+        } else {
+            upper_index = start;
+            for (std::size_t step = 1; step <= start; step *= 2) {
+                const std::size_t probe = start - step;
+                if (load_position(base + stride * probe) < key) {
+                    lower_index = probe + 1;
+                    break;
+                }
+                upper_index = probe;
+            }
+        }
+        while (lower_index < upper_index) {
             const std::size_t middle_index =
                 lower_index + (upper_index - lower_index) / 2;
-            const CompressedPosition64 center = get_position(middle_index);
-            if (center < compressed) {
+            if (load_position(base + stride * middle_index) < key) {
                 lower_index = middle_index + 1;
-            } else if (center > compressed) {
-                upper_index = middle_index - 1;
             } else {
-                return get_score(middle_index);
+                upper_index = middle_index;
+            }
+        }
+        hint = lower_index;
+        if ((lower_index < count) &&
+            (load_position(base + stride * lower_index) == key)) {
+            return lower_index;
+        }
+        return count;
+    }
+
+
+    Key get_position(std::size_t index) const {
+        return load_position(entries + ENTRY_SIZE * index);
+    }
+
+
+    int get_score(std::size_t index) const {
+        return static_cast<int>(*static_cast<const signed char *>(
+            static_cast<const void *>(
+                entries + ENTRY_SIZE * index + POSITION_SIZE
+            )
+        ));
+    }
+
+
+    Key get_wdl_block_position(std::size_t block) const {
+        return load_position(wdl_entries + WDL_INDEX_ENTRY_SIZE * block);
+    }
+
+
+    // Points ptr and end at the differences stored for the given block of
+    // the WDL table.
+    void get_wdl_block_payload(
+        std::size_t block, const unsigned char *&ptr, const unsigned char *&end
+    ) const {
+        const auto offset = [this](std::size_t b) {
+            std::uint64_t result;
+            std::memcpy(
+                &result,
+                wdl_entries + WDL_INDEX_ENTRY_SIZE * b + POSITION_SIZE,
+                sizeof(result)
+            );
+            return result;
+        };
+        const std::uint64_t begin_offset = offset(block);
+        const std::uint64_t end_offset =
+            (block + 1 < wdl_num_blocks(num_wdl_entries)) ? offset(block + 1)
+                                                          : wdl_payload_size;
+        exit_if(
+            (begin_offset > end_offset) || (end_offset > wdl_payload_size),
+            "ERROR: WDL table file ",
+            wdl_path,
+            " is malformed."
+        );
+        ptr = wdl_payload + begin_offset;
+        end = wdl_payload + end_offset;
+    }
+
+
+    // Adds the next difference of a block of the WDL table to position.
+    void read_wdl_delta(
+        const unsigned char *&ptr, const unsigned char *end, Key &position
+    ) const {
+        WORD delta;
+        exit_if(
+            !read_varint(ptr, end, delta) || (delta == 0) ||
+                (position.data + delta < position.data),
+            "ERROR: WDL table file ",
+            wdl_path,
+            " is malformed."
+        );
+        position.data += delta;
+    }
+
+
+    // Decodes the position at index from the start of its block.
+    Key get_wdl_position(std::size_t index) const {
+        const std::size_t block = index / WDL_BLOCK_SIZE;
+        Key position = get_wdl_block_position(block);
+        const unsigned char *ptr;
+        const unsigned char *end;
+        get_wdl_block_payload(block, ptr, end);
+        for (std::size_t i = 0; i < index % WDL_BLOCK_SIZE; ++i) {
+            read_wdl_delta(ptr, end, position);
+        }
+        return position;
+    }
+
+
+    // Returns the index of position in the WDL table, or num_wdl_entries if
+    // it is not present.
+    std::size_t find_wdl(const Key &position) const {
+        // Find the last block whose first position is not after position.
+        std::size_t lower_block = 0;
+        std::size_t upper_block = wdl_num_blocks(num_wdl_entries);
+        while (lower_block < upper_block) {
+            const std::size_t middle_block =
+                lower_block + (upper_block - lower_block) / 2;
+            if (get_wdl_block_position(middle_block) <= position) {
+                lower_block = middle_block + 1;
+            } else {
+                upper_block = middle_block;
             }
         }
+        if (lower_block == 0) { return num_wdl_entries; }
+        const std::size_t block = lower_block - 1;
+        std::size_t index = WDL_BLOCK_SIZE * block;
+        const std::size_t block_end =
+            std::min(index + WDL_BLOCK_SIZE, num_wdl_entries);
+        Key current = get_wdl_block_position(block);
+        const unsigned char *ptr;
+        const unsigned char *end;
+        get_wdl_block_payload(block, ptr, end);
+        while (current < position) {
+            if (++index == block_end) { return num_wdl_entries; }
+            read_wdl_delta(ptr, end, current);
+        }
+        return (current == position) ? index : num_wdl_entries;
+    }
+
+
+    Evaluation get_wdl(std::size_t index) const {
+        const unsigned char packed =
+            static_cast<unsigned char>(wdl_codes[index / 4]);
+        return static_cast<Evaluation>((packed >> (2 * (index % 4))) & 3);
+    }
+
+
+    // Scores a position that is absent from the table, which is only
+    // possible if a search can score it (see calculate_score).
+    template <
+        Player PLAYER,
+        unsigned NUM_ROWS,
+        unsigned NUM_COLS,
+        unsigned DEPTH>
+    static int search_score(const Key &position) {
+        const int score = position.decompress()
+                              .template calculate_score<
+                                  PLAYER,
+                                  NUM_ROWS,
+                                  NUM_COLS,
+                                  DEPTH + 1>();
+        exit_if(score == INT_MIN, "ERROR: Inconclusive search.");
+        return score;
+    }
+
+
+    // Returns the score stored for position, or nothing if it is absent from
+    // the table.
+    std::optional<int> find_score(const Key &position) const {
+        exit_if(!table_file, "ERROR: No distance table has been loaded.");
+        if (may_contain(position)) {
+            const std::size_t index =
+                find(entries, ENTRY_SIZE, num_entries, position);
+            if (index != num_entries) { return get_score(index); }
+        }
+        return std::nullopt;
+    }
+
+
+    template <
+        Player PLAYER,
+        unsigned NUM_ROWS,
+        unsigned NUM_COLS,
+        unsigned DEPTH>
+    int lookup_score(const Key &position) const {
+        if (const std::optional<int> score = find_score(position)) {
+            return *score;
+        }
+        return search_score<PLAYER, NUM_ROWS, NUM_COLS, DEPTH>(position);
+    }
+
+
+    // Same as lookup_score(position), but searches the table with find_near
+    // from the given hint, which is updated for the next lookup.
+    template <
+        Player PLAYER,
+        unsigned NUM_ROWS,
+        unsigned NUM_COLS,
+        unsigned DEPTH>
+    int lookup_score(const Key &position, std::size_t &hint) const {
+        exit_if(!table_file, "ERROR: No distance table has been loaded.");
+        if (may_contain(position)) {
+            const std::size_t index =
+                find_near(entries, ENTRY_SIZE, num_entries, position, hint);
+            if (index != num_entries) { return get_score(index); }
+        }
+        return search_score<PLAYER, NUM_ROWS, NUM_COLS, DEPTH>(position);
     }
 
 
@@ -129,27 +622,91 @@ struct MemoryMappedTable {
         unsigned NUM_ROWS,
         unsigned NUM_COLS,
         unsigned DEPTH>
-    int evaluate(const CompressedPosition64 &position) {
-        const Position128 decompressed = position.decompress();
-        if (decompressed.won<other(PLAYER)>()) { return -1; }
+    Evaluation lookup_wdl(const Key &position) const {
+        if (!wdl_file) {
+            return score_to_evaluation(
+                lookup_score<PLAYER, NUM_ROWS, NUM_COLS, DEPTH>(position)
+            );
+        }
+        if (may_contain(position)) {
+            const std::size_t index = find_wdl(position);
+            if (index != num_wdl_entries) { return get_wdl(index); }
+        }
+        const Evaluation eval =
+            position.decompress()
+                .template evaluate<PLAYER, NUM_ROWS, NUM_COLS, DEPTH + 1>();
+        exit_if(eval == Evaluation::UNKNOWN, "ERROR: Inconclusive search.");
+        return eval;
+    }
+
+
+    template <
+        Player PLAYER,
+        unsigned NUM_ROWS,
+        unsigned NUM_COLS,
+        unsigned DEPTH>
+    int evaluate(const Key &position) const {
+        return evaluate_with<PLAYER, NUM_ROWS, NUM_COLS>(
+            position,
+            [this](unsigned, const Key &child) {
+                return lookup_score<other(PLAYER), NUM_ROWS, NUM_COLS, DEPTH>(
+                    child
+                );
+            }
+        );
+    }
+
+
+    template <
+        Player PLAYER,
+        unsigned NUM_ROWS,
+        unsigned NUM_COLS,
+        unsigned DEPTH>
+    int evaluate(const Key &position, LookupCursor &cursor) const {
+        return evaluate_with<PLAYER, NUM_ROWS, NUM_COLS>(
+            position,
+            [this, &cursor](unsigned col, const Key &child) {
+                return lookup_score<other(PLAYER), NUM_ROWS, NUM_COLS, DEPTH>(
+                    child, cursor.hints[col]
+                );
+            }
+        );
+    }
+
+
+    // Scores position from the scores of its children, which are obtained by
+    // calling lookup(col, child) for the child reached by playing in col.
+    template <
+        Player PLAYER,
+        unsigned NUM_ROWS,
+        unsigned NUM_COLS,
+        typename LOOKUP>
+    static int evaluate_with(const Key &position, const LOOKUP &lookup) {
+        const Position<WORD> decompressed = position.decompress();
+        if (decompressed.template won<other(PLAYER)>()) { return -1; }
+        const WORD legal = position.template moves<NUM_ROWS, NUM_COLS>();
+        // A child in which PLAYER has just won scores -1 without any lookup.
+        for (WORD rest = legal; rest; rest &= rest - 1) {
+            if (decompressed.template wins_with<PLAYER>(rest & -rest)) {
+                return +1;
+            }
+        }
         int best_negative = INT_MIN;
         int best_positive = 0;
         bool has_draw = false;
         for (unsigned col = 0; col < NUM_COLS; ++col) {
-            if (const Position128 next =
-                    decompressed.move<PLAYER, NUM_ROWS>(col)) {
-                const int score =
-                    lookup_score<other(PLAYER), NUM_ROWS, NUM_COLS, DEPTH>(next
-                    );
-                if (score == -1) {
-                    return +1;
-                } else if (score < 0) {
-                    best_negative = std::max(best_negative, score);
-                } else if (score > 0) {
-                    best_positive = std::max(best_positive, score);
-                } else {
-                    has_draw = true;
-                }
+            const WORD piece = legal & (BitBoard<WORD>::COLUMN << (8 * col));
+            if (!piece) { continue; }
+            const int score =
+                lookup(col, position.template play<PLAYER>(piece));
+            if (score == -1) {
+                return +1;
+            } else if (score < 0) {
+                best_negative = std::max(best_negative, score);
+            } else if (score > 0) {
+                best_positive = std::max(best_positive, score);
+            } else {
+                has_draw = true;
             }
         }
         return (best_negative > INT_MIN) ? (1 - best_negative)
@@ -0,0 +1,89 @@
+#ifndef DZC4_OPENING_BOOK_HPP_INCLUDED
+#define DZC4_OPENING_BOOK_HPP_INCLUDED
+
+#include <cstddef>  // for std::size_t
+#include <optional> // for std::optional
+#include <span>     // for std::span
+
+#include "CompressedPosition.hpp"
+
+namespace dzc4 {
+
+
+// An opening book holds the scores of every position in the first few plies
+// of a solved board in sorted arrays that are compiled into the program, so
+// that queries near the root are answered without opening (or even looking
+// for) any table file. Books are generated from solved tables by
+// src_old/makebook.cpp, which writes a header-like file defining an array of
+// keys named OPENING_BOOK_KEYS and an array of the same length of scores
+// named OPENING_BOOK_SCORES (see src_old/PositionScorer.hpp).
+
+// Keys and scores are kept in separate arrays so that neither is padded: a
+// book with 64-bit keys takes 9 bytes per position. A key depends on the
+// width of the WORD it was made with, since every unused column of a
+// CompressedPosition holds a sentinel bit, so a book only matches programs
+// built with the same key width.
+
+
+template <typename WORD>
+struct OpeningBook {
+
+
+    using Key = CompressedPosition<WORD>;
+
+
+    std::span<const WORD> keys;
+    std::span<const signed char> scores;
+
+
+    explicit constexpr OpeningBook(
+        std::span<const WORD> book_keys,
+        std::span<const signed char> book_scores
+    ) noexcept
+        : keys(book_keys)
+        , scores(book_scores) {}
+
+
+    constexpr Key get_position(std::size_t index) const noexcept {
+        return Key(keys[index]);
+    }
+
+
+    // Returns true if there is a score for every key and the keys are
+    // strictly increasing, as find() requires. (Meant to be checked in a
+    // static_assert.)
+    constexpr bool is_valid() const noexcept {
+        if (keys.size() != scores.size()) { return false; }
+        for (std::size_t i = 1; i < keys.size(); ++i) {
+            if (!(get_position(i - 1) < get_position(i))) { return false; }
+        }
+        return true;
+    }
+
+
+    // Returns the score of position, or nothing if it is not in the book.
+    constexpr std::optional<int> find(const Key &position) const noexcept {
+        std::size_t lower_index = 0;
+        std::size_t upper_index = keys.size();
+        while (lower_index < upper_index) {
+            const std::size_t middle_index =
+                lower_index + (upper_index - lower_index) / 2;
+            const Key center = get_position(middle_index);
+            if (center < position) {
+                lower_index = middle_index + 1;
+            } else if (center > position) {
+                upper_index = middle_index;
+            } else {
+                return scores[middle_index];
+            }
+        }
+        return std::nullopt;
+    }
+
+
+}; // struct OpeningBook
+
+
+} // namespace dzc4
+
+#endif // DZC4_OPENING_BOOK_HPP_INCLUDED
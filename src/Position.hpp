@@ -0,0 +1,268 @@
+#ifndef DZC4_POSITION_HPP_INCLUDED
+#define DZC4_POSITION_HPP_INCLUDED
+
+#include <algorithm> // for std::max
+#include <climits>   // for INT_MIN
+#include <cstdint>   // for std::uint64_t
+
+#include "BitBoard.hpp" // for BitBoard
+
+namespace dzc4 {
+
+
+// As in chess, white goes first.
+enum class Player { WHITE, BLACK };
+enum class Evaluation { WIN, LOSS, DRAW, UNKNOWN };
+
+
+constexpr Player other(Player player) noexcept {
+    switch (player) {
+        case Player::WHITE: return Player::BLACK;
+        case Player::BLACK: return Player::WHITE;
+    }
+}
+
+
+// Collapses a score (see calculate_score below) to the win/draw/loss
+// evaluation it implies for the player to move.
+constexpr Evaluation score_to_evaluation(int score) noexcept {
+    return (score > 0) ? Evaluation::WIN
+           : (score < 0) ? Evaluation::LOSS
+                         : Evaluation::DRAW;
+}
+
+
+// Position is a structure that represents a game state in Connect Four. It
+// consists of a pair of BitBoards, one for each player's pieces, so a
+// Position128 (made of two BitBoard64s) takes 128 bits.
+
+
+template <typename WORD>
+struct Position {
+
+
+    BitBoard<WORD> white;
+    BitBoard<WORD> black;
+
+
+    explicit constexpr Position(
+        const BitBoard<WORD> &white_board, const BitBoard<WORD> &black_board
+    ) noexcept
+        : white(white_board)
+        , black(black_board) {}
+
+
+    constexpr BitBoard<WORD> full_board() const noexcept {
+        return BitBoard<WORD>(white.data | black.data);
+    }
+
+
+    constexpr operator bool() const noexcept {
+        return static_cast<bool>(white.data | black.data);
+    }
+
+
+    template <Player PLAYER>
+    constexpr Position place(WORD new_piece) const noexcept {
+        if constexpr (PLAYER == Player::WHITE) {
+            return Position(BitBoard<WORD>(white.data | new_piece), black);
+        } else if constexpr (PLAYER == Player::BLACK) {
+            return Position(white, BitBoard<WORD>(black.data | new_piece));
+        } else {
+            static_assert(false);
+        }
+    }
+
+
+    // Returns a mask with one bit set for each legal move, marking the space
+    // that a piece dropped into that column would occupy.
+    template <unsigned NUM_ROWS, unsigned NUM_COLS>
+    constexpr WORD moves() const noexcept {
+        return full_board().lowest_empty() &
+               BitBoard<WORD>::template playable<NUM_ROWS, NUM_COLS>();
+    }
+
+
+    template <Player PLAYER, unsigned NUM_ROWS>
+    constexpr Position move(unsigned col) const noexcept {
+        const WORD new_piece =
+            moves<NUM_ROWS, BitBoard<WORD>::MAX_COLS>() &
+            (BitBoard<WORD>::COLUMN << (8 * col));
+        if (new_piece) {
+            return place<PLAYER>(new_piece);
+        } else {
+            return Position(BitBoard<WORD>(0), BitBoard<WORD>(0));
+        }
+    }
+
+
+    template <Player PLAYER>
+    constexpr BitBoard<WORD> board() const noexcept {
+        if constexpr (PLAYER == Player::WHITE) {
+            return white;
+        } else if constexpr (PLAYER == Player::BLACK) {
+            return black;
+        } else {
+            static_assert(false);
+        }
+    }
+
+
+    template <Player PLAYER>
+    constexpr WORD won() const noexcept {
+        return board<PLAYER>().won();
+    }
+
+
+    // Returns true if PLAYER would complete four in a row by playing at
+    // new_piece. Only PLAYER's board is examined, since a move can never
+    // complete a line for the opponent.
+    template <Player PLAYER>
+    constexpr bool wins_with(WORD new_piece) const noexcept {
+        return static_cast<bool>(
+            BitBoard<WORD>(board<PLAYER>().data | new_piece).won()
+        );
+    }
+
+
+    template <
+        Player PLAYER,
+        unsigned NUM_ROWS,
+        unsigned NUM_COLS,
+        unsigned DEPTH>
+    constexpr Evaluation evaluate() const noexcept {
+        if (won<PLAYER>()) { return Evaluation::WIN; }
+        if (won<other(PLAYER)>()) { return Evaluation::LOSS; }
+        return evaluate_unwon<PLAYER, NUM_ROWS, NUM_COLS, DEPTH>();
+    }
+
+
+    // Same as evaluate(), but assumes that neither player has four in a row.
+    // Every move is first tested with wins_with(), which resolves immediate
+    // wins before any deeper search and guarantees that the children passed
+    // down the recursion have no four in a row either. Below the root, only
+    // the mover's board is ever scanned, and only once per move.
+    template <
+        Player PLAYER,
+        unsigned NUM_ROWS,
+        unsigned NUM_COLS,
+        unsigned DEPTH>
+    constexpr Evaluation evaluate_unwon() const noexcept {
+        if constexpr (DEPTH == 0) {
+            return Evaluation::UNKNOWN;
+        } else {
+            const WORD legal = moves<NUM_ROWS, NUM_COLS>();
+            for (WORD rest = legal; rest; rest &= rest - 1) {
+                if (wins_with<PLAYER>(rest & -rest)) {
+                    return Evaluation::WIN;
+                }
+            }
+            bool has_unknown = false;
+            bool has_draw = false;
+            if constexpr (DEPTH > 1) {
+                for (WORD rest = legal; rest; rest &= rest - 1) {
+                    const Position next = place<PLAYER>(rest & -rest);
+                    const Evaluation eval = next.evaluate_unwon<
+                        other(PLAYER),
+                        NUM_ROWS,
+                        NUM_COLS,
+                        DEPTH - 1>();
+                    if (eval == Evaluation::LOSS) { return Evaluation::WIN; }
+                    if (eval == Evaluation::UNKNOWN) { has_unknown = true; }
+                    if (eval == Evaluation::DRAW) { has_draw = true; }
+                }
+            } else {
+                has_unknown = static_cast<bool>(legal);
+            }
+            const bool has_move = static_cast<bool>(legal);
+            return has_unknown               ? Evaluation::UNKNOWN
+                   : (has_draw || !has_move) ? Evaluation::DRAW
+                                             : Evaluation::LOSS;
+        }
+    }
+
+
+    // a score of -1 indicates that the player to move has already lost
+    //     (i.e., their opponent already has four pieces in a row).
+    // a score of zero indicates a theoretically drawn game.
+    // a score of +1 indicates that the player to move has a winning move.
+    // a score of -2 indicates that the player to move has no move that will
+    //     prevent their opponent from winning on their next move.
+    // a score of +3 indicates that the player to move has a move such that, no
+    //     matter how their opponent replies, they can win on their next move.
+    // a score of -4 indicates that the player to move has no move that will
+    //     prevent their opponent from winning on the move after their next.
+
+
+    template <
+        Player PLAYER,
+        unsigned NUM_ROWS,
+        unsigned NUM_COLS,
+        unsigned DEPTH>
+    constexpr int calculate_score() const noexcept {
+        if (won<other(PLAYER)>()) { return -1; }
+        return calculate_score_unwon<PLAYER, NUM_ROWS, NUM_COLS, DEPTH>();
+    }
+
+
+    // Same as calculate_score(), but assumes that neither player has four in
+    // a row. (See evaluate_unwon() above.)
+    template <
+        Player PLAYER,
+        unsigned NUM_ROWS,
+        unsigned NUM_COLS,
+        unsigned DEPTH>
+    constexpr int calculate_score_unwon() const noexcept {
+        if constexpr (DEPTH == 0) {
+            return INT_MIN;
+        } else {
+            const WORD legal = moves<NUM_ROWS, NUM_COLS>();
+            for (WORD rest = legal; rest; rest &= rest - 1) {
+                if (wins_with<PLAYER>(rest & -rest)) {
+                    return +1;
+                }
+            }
+            if constexpr (DEPTH == 1) {
+                return legal ? INT_MIN : 0;
+            } else {
+                int best_negative = INT_MIN;
+                int best_positive = 0;
+                bool has_unknown = false;
+                bool has_draw = false;
+                for (WORD rest = legal; rest; rest &= rest - 1) {
+                    const Position next = place<PLAYER>(rest & -rest);
+                    const int score = next.calculate_score_unwon<
+                        other(PLAYER),
+                        NUM_ROWS,
+                        NUM_COLS,
+                        DEPTH - 1>();
+                    if (score == INT_MIN) {
+                        has_unknown = true;
+                    } else if (score < 0) {
+                        best_negative = std::max(best_negative, score);
+                    } else if (score > 0) {
+                        best_positive = std::max(best_positive, score);
+                    } else {
+                        has_draw = true;
+                    }
+                }
+                return (best_negative > INT_MIN) ? (1 - best_negative)
+                       : has_unknown             ? INT_MIN
+                       : has_draw                ? 0
+                       : (best_positive > 0)     ? (-best_positive - 1)
+                                                 : 0;
+            }
+        }
+    }
+
+
+}; // struct Position
+
+
+using Position128 = Position<std::uint64_t>;
+using Position256 = Position<unsigned __int128>;
+
+
+} // namespace dzc4
+
+#endif // DZC4_POSITION_HPP_INCLUDED
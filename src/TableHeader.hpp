@@ -0,0 +1,246 @@
+#ifndef DZC4_TABLE_HEADER_HPP_INCLUDED
+#define DZC4_TABLE_HEADER_HPP_INCLUDED
+
+#include <algorithm>   // for std::equal
+#include <bit>         // for std::rotl
+#include <cstddef>     // for std::size_t
+#include <cstdint>     // for std::uint32_t, std::uint64_t
+#include <cstring>     // for std::memcpy
+#include <type_traits> // for std::is_trivially_copyable_v
+
+#include "BloomFilter.hpp" // for BloomFilter::mix
+#include "Utilities.hpp"
+
+namespace dzc4 {
+
+
+// A table file written by this version of dzc4 begins with a TableHeader,
+// padded with zeros to TABLE_HEADER_SIZE bytes, which describes the table
+// and records the location of each of its sections:
+//
+//     header   (TABLE_HEADER_SIZE bytes)
+//     data     (data_size bytes at data_offset): the entries themselves,
+//              in the layout given by encoding (see MemoryMappedTable.hpp)
+//     filter   (filter_size bytes at filter_offset, possibly empty): a
+//              Bloom filter over the positions in the table
+//
+// Every section starts on a 64-byte boundary. The header checksum covers
+// the header itself, so a table can be validated and opened in constant
+// time. The body checksum covers everything after the header (both sections
+// and the padding between them), and is only checked on request (see
+// MemoryMappedTable::verify_checksum).
+
+// Distance tables without a header (i.e., not starting with TABLE_MAGIC),
+// as written by solvers that predate it, are still accepted, in which case
+// the file consists of a bare data section. WDL tables always have one.
+
+// A table with a nonzero prune_depth leaves out every position whose score a
+// calculate_score search of that depth finds on its own. Lookups of such
+// positions miss, and fall back to a search at least that deep (see
+// MemoryMappedTable::lookup_score), so prune_depth may be at most depth + 1.
+
+
+constexpr char TABLE_MAGIC[8] = {'\0', 'D', 'Z', 'C', '4', 'T', 'B', 'L'};
+constexpr std::uint32_t TABLE_VERSION = 2;
+constexpr std::size_t TABLE_HEADER_SIZE = 4096;
+constexpr std::size_t TABLE_SECTION_ALIGNMENT = 64;
+
+
+enum class TableEncoding : std::uint32_t { DISTANCE = 1, WDL = 2 };
+
+
+// Hashes a block of memory eight bytes at a time. (The final partial word,
+// if any, is padded with zeros.)
+inline std::uint64_t table_checksum(const char *data, std::size_t size) {
+    std::uint64_t hash = size;
+    std::size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        hash = (std::rotl(hash, 5) ^ word) * 0x9E3779B97F4A7C15;
+    }
+    if (i < size) {
+        std::uint64_t word = 0;
+        std::memcpy(&word, data + i, size - i);
+        hash = (std::rotl(hash, 5) ^ word) * 0x9E3779B97F4A7C15;
+    }
+    return BloomFilter::mix(hash);
+}
+
+
+constexpr std::uint64_t align_section(std::uint64_t offset) noexcept {
+    return (offset + TABLE_SECTION_ALIGNMENT - 1) /
+           TABLE_SECTION_ALIGNMENT * TABLE_SECTION_ALIGNMENT;
+}
+
+
+struct TableHeader {
+
+
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t header_size;
+    std::uint32_t num_rows;
+    std::uint32_t num_cols;
+    std::uint32_t key_size;
+    TableEncoding encoding;
+    std::uint32_t ply;
+    std::uint32_t depth;
+    std::uint32_t prune_depth; // 0 if the table is not pruned
+    std::uint32_t reserved;    // always 0
+    std::uint64_t num_entries;
+    std::uint64_t min_key[2]; // low word first
+    std::uint64_t max_key[2]; // low word first
+    std::uint64_t data_offset;
+    std::uint64_t data_size;
+    std::uint64_t filter_offset;
+    std::uint64_t filter_size;
+    std::uint64_t file_size;
+    std::uint64_t body_checksum;
+    std::uint64_t header_checksum;
+
+
+    template <typename WORD>
+    static constexpr void store_key(std::uint64_t (&dst)[2], WORD key) {
+        dst[0] = static_cast<std::uint64_t>(key);
+        if constexpr (sizeof(WORD) > 8) {
+            dst[1] = static_cast<std::uint64_t>(key >> 64);
+        } else {
+            dst[1] = 0;
+        }
+    }
+
+
+    template <typename WORD>
+    static constexpr WORD load_key(const std::uint64_t (&src)[2]) {
+        if constexpr (sizeof(WORD) > 8) {
+            return (static_cast<WORD>(src[1]) << 64) | src[0];
+        } else {
+            return static_cast<WORD>(src[0]);
+        }
+    }
+
+
+    std::uint64_t compute_header_checksum() const {
+        TableHeader copy = *this;
+        copy.header_checksum = 0;
+        return table_checksum(char_ptr_to(copy), sizeof(TableHeader));
+    }
+
+
+    // Returns true if a file of the given size begins with TABLE_MAGIC.
+    static bool is_present(const char *file_data, std::size_t file_size) {
+        return (file_size >= sizeof(TABLE_MAGIC)) &&
+               std::equal(TABLE_MAGIC, TABLE_MAGIC + 8, file_data);
+    }
+
+
+    // Reads and validates the header of a table file, exiting with an error
+    // if the header is malformed, was written by a different version of
+    // dzc4, or describes sections that do not fit in the file.
+    static TableHeader
+    read(const char *path, const char *file_data, std::size_t file_size) {
+        TableHeader header;
+        exit_if(
+            file_size < TABLE_HEADER_SIZE,
+            "ERROR: Table file ",
+            path,
+            " is truncated."
+        );
+        std::memcpy(char_ptr_to(header), file_data, sizeof(TableHeader));
+        exit_if(
+            header.version != TABLE_VERSION,
+            "ERROR: Table file ",
+            path,
+            " has version ",
+            header.version,
+            " (expected ",
+            TABLE_VERSION,
+            ")."
+        );
+        exit_if(
+            (header.header_size != TABLE_HEADER_SIZE) ||
+                (header.header_checksum != header.compute_header_checksum()),
+            "ERROR: Table file ",
+            path,
+            " has a corrupt header."
+        );
+        exit_if(
+            header.file_size != file_size,
+            "ERROR: Table file ",
+            path,
+            " has size ",
+            file_size,
+            " (expected ",
+            header.file_size,
+            ")."
+        );
+        exit_if(
+            header.prune_depth > header.depth + 1,
+            "ERROR: Table file ",
+            path,
+            " was pruned at depth ",
+            header.prune_depth,
+            ", deeper than its lookups search."
+        );
+        const std::uint64_t data_end = header.data_offset + header.data_size;
+        const std::uint64_t filter_end =
+            header.filter_offset + header.filter_size;
+        exit_if(
+            (header.data_offset < TABLE_HEADER_SIZE) ||
+                (header.data_offset % TABLE_SECTION_ALIGNMENT != 0) ||
+                (header.filter_offset % TABLE_SECTION_ALIGNMENT != 0) ||
+                (data_end > header.filter_offset) || (filter_end > file_size),
+            "ERROR: Table file ",
+            path,
+            " has malformed sections."
+        );
+        return header;
+    }
+
+
+    // Exits with an error unless this header describes a table for the
+    // given board, ply and search depth.
+    void expect(
+        const char *path,
+        unsigned expected_rows,
+        unsigned expected_cols,
+        unsigned expected_ply,
+        unsigned expected_depth
+    ) const {
+        exit_if(
+            (num_rows != expected_rows) || (num_cols != expected_cols) ||
+                (ply != expected_ply) || (depth != expected_depth),
+            "ERROR: Table file ",
+            path,
+            " holds ply ",
+            ply,
+            " of a ",
+            num_cols,
+            "x",
+            num_rows,
+            " board at depth ",
+            depth,
+            ", not ply ",
+            expected_ply,
+            " of a ",
+            expected_cols,
+            "x",
+            expected_rows,
+            " board at depth ",
+            expected_depth,
+            "."
+        );
+    }
+
+
+}; // struct TableHeader
+
+
+static_assert(std::is_trivially_copyable_v<TableHeader>);
+static_assert(sizeof(TableHeader) <= TABLE_HEADER_SIZE);
+
+
+} // namespace dzc4
+
+#endif // DZC4_TABLE_HEADER_HPP_INCLUDED
@@ -0,0 +1,162 @@
+#ifndef DZC4_THREAD_POOL_HPP_INCLUDED
+#define DZC4_THREAD_POOL_HPP_INCLUDED
+
+#include <algorithm>          // for std::max, std::min
+#include <atomic>             // for std::atomic
+#include <condition_variable> // for std::condition_variable
+#include <cstddef>            // for std::size_t
+#include <cstdint>            // for std::uint64_t
+#include <functional>         // for std::function
+#include <mutex>              // for std::mutex, std::unique_lock
+#include <thread>             // for std::thread
+#include <vector>             // for std::vector
+
+namespace dzc4 {
+
+
+// ThreadPool keeps a fixed set of worker threads alive for the lifetime of
+// a solve, so that each batch of positions can be handed to parallel_for
+// without paying for thread creation. The calling thread takes part in
+// every parallel_for, so a pool of size 1 has no workers at all and runs
+// everything inline.
+
+
+class ThreadPool {
+
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable work_available;
+    std::condition_variable work_done;
+    std::function<void(std::size_t, std::size_t)> job;
+    std::atomic<std::size_t> next_index;
+    std::size_t end_index;
+    std::size_t grain_size;
+    std::uint64_t generation;
+    unsigned busy_workers;
+    bool stopping;
+
+
+    // Claims and runs ranges of the current job until none are left.
+    void run_job() {
+        while (true) {
+            const std::size_t begin = next_index.fetch_add(grain_size);
+            if (begin >= end_index) { return; }
+            job(begin, std::min(begin + grain_size, end_index));
+        }
+    }
+
+
+    void worker_loop() {
+        std::uint64_t seen_generation = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                work_available.wait(lock, [&] {
+                    return stopping || (generation != seen_generation);
+                });
+                if (stopping) { return; }
+                seen_generation = generation;
+            }
+            run_job();
+            std::unique_lock<std::mutex> lock(mutex);
+            if (--busy_workers == 0) { work_done.notify_one(); }
+        }
+    }
+
+
+public:
+
+
+    // A num_threads of 0 uses one thread per hardware thread.
+    explicit ThreadPool(unsigned num_threads)
+        : next_index(0)
+        , end_index(0)
+        , grain_size(1)
+        , generation(0)
+        , busy_workers(0)
+        , stopping(false) {
+        if (num_threads == 0) {
+            num_threads = std::max(1U, std::thread::hardware_concurrency());
+        }
+        for (unsigned i = 1; i < num_threads; ++i) {
+            workers.emplace_back([this] { worker_loop(); });
+        }
+    }
+
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+
+    ~ThreadPool() {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        work_available.notify_all();
+        for (std::thread &worker : workers) { worker.join(); }
+    }
+
+
+    unsigned size() const noexcept {
+        return static_cast<unsigned>(workers.size()) + 1;
+    }
+
+
+    // Splits [begin, end) into small contiguous ranges, calls
+    // body(range_begin, range_end) for each of them, spread across all threads
+    // of the pool, and returns once every call has returned. Ranges are handed
+    // out on demand, so that threads that draw cheap positions simply take on
+    // more of them. Each range is processed by a single thread in one call,
+    // so body may keep state (e.g., a lookup cursor) from one index to the
+    // next within a range.
+    template <typename F>
+    void
+    parallel_for_ranges(std::size_t begin, std::size_t end, const F &body) {
+        if (begin >= end) { return; }
+        if (workers.empty()) {
+            body(begin, end);
+            return;
+        }
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            job = [&body](std::size_t range_begin, std::size_t range_end) {
+                body(range_begin, range_end);
+            };
+            next_index = begin;
+            end_index = end;
+            grain_size = std::max<std::size_t>(
+                1, (end - begin) / (16 * static_cast<std::size_t>(size()))
+            );
+            busy_workers = static_cast<unsigned>(workers.size());
+            ++generation;
+        }
+        work_available.notify_all();
+        run_job();
+        std::unique_lock<std::mutex> lock(mutex);
+        work_done.wait(lock, [&] { return busy_workers == 0; });
+    }
+
+
+    // Calls body(i) for every i in [begin, end), as parallel_for_ranges does.
+    template <typename F>
+    void parallel_for(std::size_t begin, std::size_t end, const F &body) {
+        parallel_for_ranges(
+            begin,
+            end,
+            [&body](std::size_t range_begin, std::size_t range_end) {
+                for (std::size_t i = range_begin; i < range_end; ++i) {
+                    body(i);
+                }
+            }
+        );
+    }
+
+
+}; // class ThreadPool
+
+
+} // namespace dzc4
+
+#endif // DZC4_THREAD_POOL_HPP_INCLUDED
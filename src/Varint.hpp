@@ -0,0 +1,68 @@
+#ifndef DZC4_VARINT_HPP_INCLUDED
+#define DZC4_VARINT_HPP_INCLUDED
+
+#include <cstddef> // for std::size_t
+#include <vector>  // for std::vector
+
+namespace dzc4 {
+
+
+// A varint stores an unsigned integer in little-endian groups of 7 bits, one
+// group per byte, with the high bit of each byte set if another byte
+// follows. Sorted keys are stored as varints of the differences between
+// consecutive keys, which are much smaller than the keys themselves (see
+// src_old/FileNames.hpp and MemoryMappedTable.hpp).
+
+
+// The most bytes that a varint of a WORD may take (10 for 64-bit words and
+// 19 for 128-bit words).
+template <typename WORD>
+constexpr std::size_t MAX_VARINT_SIZE = (8 * sizeof(WORD) + 6) / 7;
+
+
+// Encodes value as a varint at ptr, which must have room for
+// MAX_VARINT_SIZE<WORD> bytes, and returns a pointer past its end.
+template <typename WORD>
+unsigned char *write_varint(unsigned char *ptr, WORD value) noexcept {
+    while (value >= 0x80) {
+        *ptr++ = static_cast<unsigned char>(value | 0x80);
+        value >>= 7;
+    }
+    *ptr++ = static_cast<unsigned char>(value);
+    return ptr;
+}
+
+
+template <typename WORD>
+void append_varint(std::vector<unsigned char> &bytes, WORD value) {
+    unsigned char encoded[MAX_VARINT_SIZE<WORD>];
+    bytes.insert(bytes.end(), encoded, write_varint(encoded, value));
+}
+
+
+// Decodes a varint from the bytes in [ptr, end) into value and advances
+// ptr past it. Returns false, leaving ptr unspecified, if the varint runs
+// past end or does not fit in a WORD.
+template <typename WORD>
+bool read_varint(
+    const unsigned char *&ptr, const unsigned char *end, WORD &value
+) noexcept {
+    constexpr unsigned WORD_BITS = 8 * sizeof(WORD);
+    value = 0;
+    for (unsigned shift = 0; ptr != end; shift += 7) {
+        const unsigned char byte = *ptr++;
+        const WORD bits = static_cast<WORD>(byte & 0x7F);
+        if ((shift >= WORD_BITS) ||
+            ((shift > WORD_BITS - 7) && (bits >> (WORD_BITS - shift)))) {
+            return false;
+        }
+        value |= bits << shift;
+        if (!(byte & 0x80)) { return true; }
+    }
+    return false;
+}
+
+
+} // namespace dzc4
+
+#endif // DZC4_VARINT_HPP_INCLUDED
@@ -2,20 +2,110 @@
 #define DZC4_CONSTANTS_HPP_INCLUDED
 
 // C++ standard library headers
-#include <cstddef> // for std::size_t
+#include <cstddef>     // for std::size_t
+#include <cstdint>     // for std::uint64_t
+#include <type_traits> // for std::conditional_t
 
-constexpr unsigned NUM_COLS = 6;
-constexpr unsigned NUM_ROWS = 4;
+// The board size, search depth, table pruning, table stride, thread count,
+// Bloom filters and data directory may be overridden on the compiler command
+// line (e.g., -DDZC4_NUM_COLS=5), which is how the harness in harness/ builds
+// a solver for each board in its matrix.
 
-static_assert(NUM_COLS <= 8, "dzc4 only supports Connect Four boards with "
-                             "up to eight columns.");
+#ifndef DZC4_NUM_COLS
+#define DZC4_NUM_COLS 6
+#endif
+
+#ifndef DZC4_NUM_ROWS
+#define DZC4_NUM_ROWS 4
+#endif
+
+#ifndef DZC4_DEPTH
+#define DZC4_DEPTH 2
+#endif
+
+#ifndef DZC4_PRUNE_TABLES
+#define DZC4_PRUNE_TABLES 0
+#endif
+
+#ifndef DZC4_TABLE_STRIDE
+#define DZC4_TABLE_STRIDE 1
+#endif
+
+#ifndef DZC4_NUM_THREADS
+#define DZC4_NUM_THREADS 0
+#endif
+
+#ifndef DZC4_WRITE_BLOOM_FILTERS
+#define DZC4_WRITE_BLOOM_FILTERS 0
+#endif
+
+#ifndef DZC4_DATA_DIRECTORY
+#define DZC4_DATA_DIRECTORY "/mnt/c/Data/"
+#endif
+
+constexpr unsigned NUM_COLS = DZC4_NUM_COLS;
+constexpr unsigned NUM_ROWS = DZC4_NUM_ROWS;
+
+static_assert(NUM_COLS <= 16, "dzc4 only supports Connect Four boards with "
+                              "up to sixteen columns.");
 static_assert(NUM_ROWS <= 7, "dzc4 only supports Connect Four boards with "
                              "up to seven rows.");
 
-constexpr unsigned DEPTH = 2;
+// Each column of a bitboard occupies one byte, so boards with more than eight
+// columns are solved with 128-bit bitboards and table keys. Defining
+// DZC4_WIDE_KEYS forces 128-bit keys on smaller boards too, which is useful
+// for checking the wide code path against the 64-bit one.
+#ifdef DZC4_WIDE_KEYS
+using BoardWord = unsigned __int128;
+#else
+using BoardWord = std::conditional_t<(NUM_COLS <= 8),
+                                     std::uint64_t, unsigned __int128>;
+#endif
+
+constexpr unsigned DEPTH = DZC4_DEPTH;
 constexpr std::size_t CHUNK_SIZE = 10000000;
 
-constexpr const char *DATA_FILENAME_PREFIX = "/mnt/c/Data/C4DATA-";
-constexpr const char *TABLE_FILENAME_PREFIX = "/mnt/c/Data/C4TABLE-";
+// If set, endstep and backstep leave every position whose score
+// calculate_score<DEPTH + 1> finds on its own out of the table, since
+// MemoryMappedTable::lookup_score recovers it with the same fallback search.
+// This shrinks tables on disk and in the page cache at the cost of one more
+// shallow search per position in backstep. (Searching any shallower would
+// prune nothing: every position in a table is one that evaluate<DEPTH> left
+// unresolved.) PRUNE_DEPTH is the depth recorded in the table header.
+constexpr bool PRUNE_TABLES = DZC4_PRUNE_TABLES;
+constexpr unsigned PRUNE_DEPTH = PRUNE_TABLES ? DEPTH + 1 : 0;
+
+// The solver only keeps the tables of plies that are multiples of TABLE_STRIDE
+// (and the table of the root). Every other table is deleted once the table
+// of the ply before it has been computed, and queries for its positions are
+// answered by reconstructing their scores from the nearest later table that
+// was kept (see SparseTables.hpp), caching up to RECONSTRUCTION_CACHE_SIZE
+// reconstructed scores.
+constexpr unsigned TABLE_STRIDE = DZC4_TABLE_STRIDE;
+constexpr std::size_t RECONSTRUCTION_CACHE_SIZE = 1 << 20;
+static_assert(TABLE_STRIDE >= 1);
+
+// endstep and backstep read positions in batches of this size and score each
+// batch on NUM_THREADS threads (0 meaning one per hardware thread). The batch
+// size must divide CHUNK_SIZE, which sets how often progress is reported.
+constexpr unsigned NUM_THREADS = DZC4_NUM_THREADS;
+constexpr std::size_t EVALUATION_BATCH_SIZE = 100000;
+static_assert(CHUNK_SIZE % EVALUATION_BATCH_SIZE == 0);
+
+// Store ply and chunk files as block-framed deltas between consecutive sorted
+// positions (see FileNames.hpp) instead of raw 8-byte positions.
+constexpr bool ENCODE_DATA_FILES = true;
+
+// Embed a Bloom filter section in each table, which lets lookups skip the
+// binary search for positions that are absent from the table. This pays off
+// once tables no longer fit in the page cache. For small boards whose tables
+// stay resident, the extra probe on every hit costs more than it saves
+// (endstep and backstep on 6x4 take about half again as long), so filters
+// are off unless DZC4_WRITE_BLOOM_FILTERS is defined to 1.
+constexpr bool WRITE_BLOOM_FILTERS = DZC4_WRITE_BLOOM_FILTERS;
+
+constexpr const char *DATA_FILENAME_PREFIX = DZC4_DATA_DIRECTORY "C4DATA-";
+constexpr const char *TABLE_FILENAME_PREFIX = DZC4_DATA_DIRECTORY "C4TABLE-";
+constexpr const char *WDL_FILENAME_PREFIX = DZC4_DATA_DIRECTORY "C4WDL-";
 
 #endif // DZC4_CONSTANTS_HPP_INCLUDED
@@ -2,10 +2,18 @@
 #define DZC4_FILENAMES_HPP_INCLUDED
 
 // C++ standard library headers
+#include <algorithm> // for std::copy, std::equal
+#include <atomic> // for std::atomic
+#include <climits> // for SCHAR_MIN
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::uint32_t, std::uint64_t
+#include <cstring> // for std::memcpy, std::memmove, std::memset
 #include <iomanip> // for std::setw and std::setfill
 #include <ios>
-#include <iostream> // for std::ifstream, std::ofstream
+#include <fstream> // for std::ifstream, std::ofstream
+#include <iostream> // for std::cout
 #include <filesystem>
+#include <optional> // for std::optional
 #include <sstream> // for std::ostringstream
 #include <string>
 #include <vector>
@@ -13,37 +21,67 @@
 // Project-specific headers
 #include "Constants.hpp"
 #include "Utilities.hpp"
-#include "CompressedPosition64.hpp"
-
-inline std::string plyfilename(unsigned ply) {
+#include "BloomFilter.hpp"
+#include "CompressedPosition.hpp"
+#include "MemoryMappedOutputFile.hpp"
+#include "MemoryMappedTable.hpp" // for the WDL table layout
+#include "Position.hpp"
+#include "TableHeader.hpp"
+#include "Varint.hpp"
+
+// Files belonging to a subtree solve (see solver.cpp) carry a tag naming the
+// opening they were solved from, so that they never collide with the files of
+// a full solve. filename_tag is empty for a full solve.
+inline std::string filename_tag;
+
+inline std::string plyfilename(unsigned ply,
+                               const std::string &tag = filename_tag) {
     std::ostringstream filename;
     filename << DATA_FILENAME_PREFIX;
     filename << std::setw(2) << std::setfill('0') << NUM_COLS;
     filename << '-';
     filename << std::setw(2) << std::setfill('0') << NUM_ROWS;
     filename << '-';
+    if (!tag.empty()) filename << tag << '-';
     filename << std::setw(4) << std::setfill('0') << ply;
     return filename.str();
 }
 
-inline std::string tabfilename(unsigned ply) {
+inline std::string tabfilename(unsigned ply,
+                               const std::string &tag = filename_tag) {
     std::ostringstream filename;
     filename << TABLE_FILENAME_PREFIX;
     filename << std::setw(2) << std::setfill('0') << NUM_COLS;
     filename << '-';
     filename << std::setw(2) << std::setfill('0') << NUM_ROWS;
     filename << '-';
+    if (!tag.empty()) filename << tag << '-';
     filename << std::setw(4) << std::setfill('0') << ply;
     return filename.str();
 }
 
-inline std::string chunkfilename(unsigned ply, unsigned chunk) {
+inline std::string wdlfilename(unsigned ply,
+                               const std::string &tag = filename_tag) {
+    std::ostringstream filename;
+    filename << WDL_FILENAME_PREFIX;
+    filename << std::setw(2) << std::setfill('0') << NUM_COLS;
+    filename << '-';
+    filename << std::setw(2) << std::setfill('0') << NUM_ROWS;
+    filename << '-';
+    if (!tag.empty()) filename << tag << '-';
+    filename << std::setw(4) << std::setfill('0') << ply;
+    return filename.str();
+}
+
+inline std::string chunkfilename(unsigned ply, unsigned chunk,
+                                 const std::string &tag = filename_tag) {
     std::ostringstream filename;
     filename << DATA_FILENAME_PREFIX;
     filename << std::setw(2) << std::setfill('0') << NUM_COLS;
     filename << '-';
     filename << std::setw(2) << std::setfill('0') << NUM_ROWS;
     filename << '-';
+    if (!tag.empty()) filename << tag << '-';
     filename << std::setw(4) << std::setfill('0') << ply;
     filename << '-';
     filename << std::setw(8) << std::setfill('0') << chunk;
@@ -55,22 +93,64 @@ inline std::string chunkfilename(unsigned ply, unsigned chunk) {
 namespace dzc4 {
 
 
+    // Positions and table keys as used by the solver, with the bitboard width
+    // chosen in Constants.hpp.
+    using SolverPosition = Position<BoardWord>;
+    using SolverKey = CompressedPosition<BoardWord>;
+
+
+    // When ENCODE_DATA_FILES is set, ply and chunk files are written as a
+    // stream of independent blocks instead of a raw array of positions:
+    //
+    //     DATA_FILE_MAGIC (8 bytes)
+    //     for each block:
+    //         number of positions in block (4 bytes)
+    //         number of payload bytes (4 bytes)
+    //         payload: first position as a varint, followed by the
+    //                  difference from each position to the next as varints
+    //                  (see Varint.hpp)
+    //     terminating block header with both counts zero (8 bytes)
+    //     total number of positions in file (8 bytes)
+    //
+    // Positions must be written in strictly increasing order, which holds for
+    // every data file the solver produces. A raw data file can never begin
+    // with DATA_FILE_MAGIC, since the first byte of every CompressedPosition
+    // contains a sentinel bit, so DataFileReader accepts either format. With
+    // 128-bit keys, a varint may take up to 19 bytes.
+
+    constexpr char DATA_FILE_MAGIC[8] = {'\0', 'D', 'Z', 'C', '4',
+                                         'D', 'V', '1'};
+    constexpr std::uint32_t DATA_BLOCK_SIZE = 65536;
+
+
+
     class DataFileWriter {
 
     private: // =============================================== MEMBER VARIABLES
 
         std::filesystem::path data_path;
         std::ofstream data_stream;
+        bool encoded;
+        std::vector<unsigned char> block;
+        std::uint32_t block_count;
+        BoardWord last_data;
+        std::uint64_t total_count;
 
     public: // ===================================================== CONSTRUCTOR
 
-        explicit DataFileWriter(const std::string &path_str) {
+        explicit DataFileWriter(const std::string &path_str) :
+                encoded(ENCODE_DATA_FILES), block_count(0),
+                last_data(0), total_count(0) {
             data_path = path_str;
             assert_nonexistence(data_path);
             data_stream.open(data_path, std::ios::binary | std::ios::out
                                                          | std::ios::trunc);
             exit_if(data_stream.fail(),
                     "ERROR: Failed to create data file ", data_path, ".");
+            if (encoded) {
+                data_stream.write(DATA_FILE_MAGIC, sizeof(DATA_FILE_MAGIC));
+                check();
+            }
         }
 
         explicit DataFileWriter(unsigned ply) :
@@ -79,23 +159,77 @@ namespace dzc4 {
         explicit DataFileWriter(unsigned ply, unsigned chunk) :
                 DataFileWriter(chunkfilename(ply, chunk)) {}
 
-    public: // ======================================= STREAM INSERTION OPERATOR
+        ~DataFileWriter() {
+            if (encoded) {
+                if (block_count != 0) flush_block();
+                const std::uint32_t terminator[2] = {0, 0};
+                data_stream.write(char_ptr_to(terminator), sizeof(terminator));
+                data_stream.write(char_ptr_to(total_count),
+                                  sizeof(total_count));
+                check();
+            }
+        }
 
-        DataFileWriter &operator<<(CompressedPosition64 posn) {
-            const char *posn_ptr = char_ptr_to(posn);
-            data_stream.write(posn_ptr, sizeof(CompressedPosition64));
+    private: // ======================================================= ENCODING
+
+        void check() {
             exit_if(data_stream.fail(),
                     "ERROR: Failed to write to data file ", data_path, ".");
+        }
+
+        // Writes out the pending block, which must not be empty, since a block
+        // header with a zero count terminates the file.
+        void flush_block() {
+            const std::uint32_t num_bytes =
+                    static_cast<std::uint32_t>(block.size());
+            data_stream.write(char_ptr_to(block_count), sizeof(block_count));
+            data_stream.write(char_ptr_to(num_bytes), sizeof(num_bytes));
+            data_stream.write(char_ptr_to(block.data()),
+                              static_cast<std::streamsize>(num_bytes));
+            check();
+            block.clear();
+            block_count = 0;
+        }
+
+        // Each block starts from a full position, so that blocks can be
+        // decoded independently, but the order is checked across blocks.
+        void encode(SolverKey posn) {
+            exit_if(total_count != 0 && posn.data <= last_data,
+                    "ERROR: Positions written to data file ", data_path,
+                    " are not strictly sorted.");
+            if (block_count == 0) {
+                append_varint(block, posn.data);
+            } else {
+                append_varint(block, posn.data - last_data);
+            }
+            last_data = posn.data;
+            ++total_count;
+            if (++block_count == DATA_BLOCK_SIZE) flush_block();
+        }
+
+    public: // ======================================= STREAM INSERTION OPERATOR
+
+        DataFileWriter &operator<<(SolverKey posn) {
+            if (encoded) {
+                encode(posn);
+                return *this;
+            }
+            const char *posn_ptr = char_ptr_to(posn);
+            data_stream.write(posn_ptr, sizeof(SolverKey));
+            check();
             return *this;
         }
 
         DataFileWriter &operator<<(
-                const std::vector<CompressedPosition64> &posns) {
+                const std::vector<SolverKey> &posns) {
+            if (encoded) {
+                for (const SolverKey &posn : posns) encode(posn);
+                return *this;
+            }
             const char * posns_ptr = char_ptr_to(posns.data());
             data_stream.write(posns_ptr,
-                              posns.size() * sizeof(CompressedPosition64));
-            exit_if(data_stream.fail(),
-                    "ERROR: Failed to write to data file ", data_path, ".");
+                              posns.size() * sizeof(SolverKey));
+            check();
             return *this;
         }
 
@@ -103,44 +237,341 @@ namespace dzc4 {
 
 
 
-    class TableFileWriter {
+    // PartialTableFile maps a new table file (see TableHeader.hpp) with room
+    // for a data section of a known size, to be filled in place by the
+    // TableFileWriter or WDLFileWriter that owns it. The file is built under
+    // a temporary ".partial" name and only renamed to its final name by
+    // commit(), after it has been checked to be complete and sorted, and
+    // flushed to disk. A solver that dies midway therefore never leaves a
+    // truncated table behind under a name that looks valid. The data section
+    // may be shrunk before the table is committed (see shrink()), e.g., once
+    // the entries of a pruned table have been compacted.
+
+    class PartialTableFile {
 
     private: // =============================================== MEMBER VARIABLES
 
         std::filesystem::path table_path;
-        std::ofstream table_stream;
+        std::filesystem::path partial_path;
+        std::optional<MemoryMappedOutputFile> table_file;
+        TableHeader header;
 
     public: // ===================================================== CONSTRUCTOR
 
-        explicit TableFileWriter(const std::string &path_str) {
+        explicit PartialTableFile(const std::string &path_str,
+                                  TableEncoding encoding, unsigned ply,
+                                  std::uintmax_t num_posns,
+                                  std::uintmax_t data_size,
+                                  unsigned prune_depth) : header() {
             table_path = path_str;
             assert_nonexistence(table_path);
-            table_stream.open(table_path, std::ios::binary | std::ios::out
-                                                           | std::ios::trunc);
-            exit_if(table_stream.fail(),
-                    "ERROR: Failed to create table file ", table_path, ".");
+            partial_path = table_path;
+            partial_path += ".partial";
+            std::copy(TABLE_MAGIC, TABLE_MAGIC + 8, header.magic);
+            header.version = TABLE_VERSION;
+            header.header_size = TABLE_HEADER_SIZE;
+            header.num_rows = NUM_ROWS;
+            header.num_cols = NUM_COLS;
+            header.key_size = sizeof(SolverKey);
+            header.encoding = encoding;
+            header.ply = ply;
+            header.depth = DEPTH;
+            header.prune_depth = prune_depth;
+            header.data_offset = TABLE_HEADER_SIZE;
+            lay_out(num_posns, data_size);
+            table_file.emplace(partial_path.c_str(), header.file_size);
         }
 
-        explicit TableFileWriter(unsigned ply) :
-                TableFileWriter(tabfilename(ply)) {}
+        PartialTableFile(const PartialTableFile &) = delete;
+        PartialTableFile &operator=(const PartialTableFile &) = delete;
 
-    public: // ======================================= STREAM INSERTION OPERATOR
+    private: // ========================================================= LAYOUT
 
-        TableFileWriter &write(CompressedPosition64 posn, int score) {
-            const char *posn_ptr = char_ptr_to(posn);
+        void lay_out(std::uintmax_t num_posns, std::uintmax_t data_size) {
+            header.num_entries = num_posns;
+            header.data_size = data_size;
+            header.filter_offset = align_section(TABLE_HEADER_SIZE + data_size);
+            header.filter_size = WRITE_BLOOM_FILTERS
+                    ? 8 * BloomFilter::num_words(num_posns) : 0;
+            header.file_size = header.filter_offset + header.filter_size;
+        }
+
+    public: // ======================================================= ACCESSORS
+
+        bool is_open() const { return table_file.has_value(); }
+
+        const std::filesystem::path &path() const { return table_path; }
+
+        std::size_t size() const { return header.num_entries; }
+
+        char *data() { return table_file->data + header.data_offset; }
+
+    public: // ===================================================== PUBLISHING
+
+        // Cuts the table down to num_posns entries in a data section of
+        // data_size bytes, which must already hold them at its start. The
+        // Bloom filter section moves up to follow the shorter data section.
+        void shrink(std::uintmax_t num_posns, std::uintmax_t data_size) {
+            exit_if(data_size > header.data_size, "ERROR: Cannot grow table ",
+                    "file ", partial_path, " by shrinking it.");
+            lay_out(num_posns, data_size);
+            const std::size_t data_end = TABLE_HEADER_SIZE + data_size;
+            std::memset(table_file->data + data_end, 0,
+                        header.file_size - data_end);
+            table_file->truncate(header.file_size);
+        }
+
+        // Same as commit(key_at), for keys stored key_stride bytes apart at
+        // the start of the data section.
+        void commit(std::size_t key_stride) {
+            const char *keys = data();
+            commit([keys, key_stride](std::size_t i) {
+                SolverKey posn;
+                std::memcpy(char_ptr_to(posn), keys + key_stride * i,
+                            sizeof(SolverKey));
+                return posn;
+            });
+        }
+
+        // Verifies that the keys of the table, which key_at(i) returns for
+        // i = 0, 1, ... in turn, are strictly increasing (an unwritten key is
+        // all zeros, which is not a valid position), fills in the Bloom
+        // filter section and the header, and publishes the table under its
+        // final name.
+        template <typename KEY_AT>
+        void commit(KEY_AT key_at) {
+            std::uint64_t *filter = static_cast<std::uint64_t *>(
+                    static_cast<void *>(table_file->data
+                                        + header.filter_offset));
+            const std::size_t num_filter_words = header.filter_size / 8;
+            SolverKey first_posn(0);
+            SolverKey last_posn(0);
+            for (std::size_t i = 0; i < header.num_entries; ++i) {
+                const SolverKey posn = key_at(i);
+                exit_if(posn <= last_posn, "ERROR: Table file ", partial_path,
+                        " is incomplete or not sorted at entry ", i, ".");
+                if (num_filter_words) {
+                    BloomFilter::insert(filter, num_filter_words, posn);
+                }
+                if (i == 0) first_posn = posn;
+                last_posn = posn;
+            }
+            TableHeader::store_key(header.min_key, first_posn.data);
+            TableHeader::store_key(header.max_key, last_posn.data);
+            header.body_checksum = table_checksum(
+                    table_file->data + TABLE_HEADER_SIZE,
+                    header.file_size - TABLE_HEADER_SIZE);
+            header.header_checksum = header.compute_header_checksum();
+            std::memcpy(table_file->data, char_ptr_to(header), sizeof(header));
+            table_file->sync();
+            table_file.reset();
+            std::error_code error;
+            std::filesystem::rename(partial_path, table_path, error);
+            exit_if(static_cast<bool>(error), "ERROR: Failed to rename ",
+                    partial_path, " to ", table_path, ".");
+        }
+
+    }; // class PartialTableFile
+
+
+
+    // TableFileWriter writes a distance table of a known number of entries in
+    // place by index, so that disjoint ranges of a table can be filled in any
+    // order (e.g., by several threads at once). An entry may be pruned instead
+    // of written (see PRUNE_TABLES in Constants.hpp), in which case its key is
+    // still stored to be checked, but a marker takes the place of its score,
+    // and commit() squeezes it out before publishing the table.
+
+    class TableFileWriter {
+
+    public: // ====================================================== CONSTANTS
+
+        static constexpr std::size_t ENTRY_SIZE = sizeof(SolverKey) + 1;
+        static constexpr signed char PRUNED_SCORE = SCHAR_MIN;
+
+    private: // =============================================== MEMBER VARIABLES
+
+        PartialTableFile table_file;
+        std::size_t next_index;
+        std::atomic<std::size_t> num_pruned;
+
+    public: // ===================================================== CONSTRUCTOR
+
+        explicit TableFileWriter(const std::string &path_str, unsigned ply,
+                                 std::uintmax_t num_posns) :
+                table_file(path_str, TableEncoding::DISTANCE, ply,
+                           num_posns, num_posns * ENTRY_SIZE, PRUNE_DEPTH),
+                next_index(0), num_pruned(0) {}
+
+        explicit TableFileWriter(unsigned ply, std::uintmax_t num_posns) :
+                TableFileWriter(tabfilename(ply), ply, num_posns) {}
+
+        ~TableFileWriter() {
+            if (table_file.is_open()) commit();
+        }
+
+    public: // ======================================================== WRITING
+
+        // Entries with distinct indices may be written concurrently.
+        void write(std::size_t index, SolverKey posn, int score) {
+            exit_if(index >= table_file.size(), "ERROR: Entry ", index,
+                    " is out of range for table file ", table_file.path(),
+                    ".");
+            char *entry_ptr = table_file.data() + ENTRY_SIZE * index;
             const signed char score_char = static_cast<signed char>(score);
-            const char *score_ptr = char_ptr_to(score_char);
-            table_stream.write(posn_ptr, sizeof(CompressedPosition64));
-            table_stream.write(score_ptr, 1);
-            exit_if(table_stream.fail(),
-                    "ERROR: Failed to write to table file ", table_path, ".");
+            std::memcpy(entry_ptr, char_ptr_to(posn), sizeof(SolverKey));
+            std::memcpy(entry_ptr + sizeof(SolverKey), &score_char, 1);
+        }
+
+        void prune(std::size_t index, SolverKey posn) {
+            write(index, posn, PRUNED_SCORE);
+            num_pruned.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        TableFileWriter &write(SolverKey posn, int score) {
+            write(next_index++, posn, score);
             return *this;
         }
 
+        void commit() {
+            const std::size_t num_posns = table_file.size();
+            if (num_pruned != 0) {
+                char *entries = table_file.data();
+                std::size_t num_kept = 0;
+                for (std::size_t i = 0; i < num_posns; ++i) {
+                    const char *entry_ptr = entries + ENTRY_SIZE * i;
+                    if (static_cast<signed char>(entry_ptr[sizeof(SolverKey)])
+                            == PRUNED_SCORE) continue;
+                    if (num_kept != i) {
+                        std::memmove(entries + ENTRY_SIZE * num_kept,
+                                     entry_ptr, ENTRY_SIZE);
+                    }
+                    ++num_kept;
+                }
+                table_file.shrink(num_kept, num_kept * ENTRY_SIZE);
+                std::cout << "Pruned " << num_posns - num_kept << " of "
+                          << num_posns << " positions from table file "
+                          << table_file.path() << "." << std::endl;
+            }
+            table_file.commit(ENTRY_SIZE);
+        }
+
     }; // class TableFileWriter
 
 
 
+    // WDLFileWriter writes a WDL table (see MemoryMappedTable.hpp for its
+    // layout) of a known number of entries, which must be written in order.
+    // The payload is written into room for the largest possible differences
+    // and the table shrunk to fit once they are all known.
+
+    class WDLFileWriter {
+
+    public: // ====================================================== CONSTANTS
+
+        using Table = MemoryMappedTable<BoardWord>;
+
+    private: // =============================================== MEMBER VARIABLES
+
+        PartialTableFile wdl_file;
+        std::size_t count;
+        std::size_t payload_size;
+        SolverKey last_posn;
+
+    public: // ===================================================== CONSTRUCTOR
+
+        // A WDL table derived from a pruned distance table holds the same
+        // positions, so it records the same prune_depth.
+        explicit WDLFileWriter(const std::string &path_str, unsigned ply,
+                               std::uintmax_t num_posns,
+                               unsigned prune_depth) :
+                wdl_file(path_str, TableEncoding::WDL, ply, num_posns,
+                         Table::wdl_payload_offset(num_posns)
+                         + MAX_VARINT_SIZE<BoardWord> * num_posns,
+                         prune_depth),
+                count(0), payload_size(0), last_posn(0) {}
+
+        explicit WDLFileWriter(unsigned ply, std::uintmax_t num_posns,
+                               unsigned prune_depth) :
+                WDLFileWriter(wdlfilename(ply), ply, num_posns, prune_depth) {}
+
+        ~WDLFileWriter() {
+            if (wdl_file.is_open()) commit();
+        }
+
+    private: // ========================================================= LAYOUT
+
+        char *codes() {
+            return wdl_file.data() + Table::WDL_INDEX_ENTRY_SIZE
+                    * Table::wdl_num_blocks(wdl_file.size());
+        }
+
+        unsigned char *payload() {
+            return static_cast<unsigned char *>(static_cast<void *>(
+                    wdl_file.data()
+                    + Table::wdl_payload_offset(wdl_file.size())));
+        }
+
+    public: // ======================================================== WRITING
+
+        WDLFileWriter &write(SolverKey posn, Evaluation eval) {
+            exit_if(count >= wdl_file.size(), "ERROR: Too many entries "
+                    "written to WDL file ", wdl_file.path(), ".");
+            if (count % Table::WDL_BLOCK_SIZE == 0) {
+                char *index_entry = wdl_file.data()
+                        + Table::WDL_INDEX_ENTRY_SIZE
+                        * (count / Table::WDL_BLOCK_SIZE);
+                const std::uint64_t offset = payload_size;
+                std::memcpy(index_entry, char_ptr_to(posn), sizeof(SolverKey));
+                std::memcpy(index_entry + sizeof(SolverKey),
+                            char_ptr_to(offset), sizeof(offset));
+            } else {
+                exit_if(posn <= last_posn, "ERROR: Positions written to WDL "
+                        "file ", wdl_file.path(), " are not strictly sorted.");
+                unsigned char *delta_ptr = payload() + payload_size;
+                payload_size = static_cast<std::size_t>(
+                        write_varint(delta_ptr, posn.data - last_posn.data)
+                        - payload());
+            }
+            char *code_ptr = codes() + count / 4;
+            *code_ptr = static_cast<char>(*code_ptr
+                    | (static_cast<unsigned>(eval) << (2 * (count % 4))));
+            last_posn = posn;
+            ++count;
+            return *this;
+        }
+
+        // Shrinks the table to fit its payload, and publishes it.
+        void commit() {
+            const std::size_t num_posns = wdl_file.size();
+            exit_if(count != num_posns, "ERROR: WDL file ", wdl_file.path(),
+                    " is incomplete.");
+            wdl_file.shrink(num_posns,
+                            Table::wdl_payload_offset(num_posns)
+                            + payload_size);
+            const char *index = wdl_file.data();
+            const unsigned char *delta_ptr = payload();
+            const unsigned char *payload_end = delta_ptr + payload_size;
+            SolverKey posn;
+            wdl_file.commit([&](std::size_t i) {
+                if (i % Table::WDL_BLOCK_SIZE == 0) {
+                    std::memcpy(char_ptr_to(posn), index
+                                + Table::WDL_INDEX_ENTRY_SIZE
+                                * (i / Table::WDL_BLOCK_SIZE),
+                                sizeof(SolverKey));
+                } else {
+                    BoardWord delta;
+                    read_varint(delta_ptr, payload_end, delta);
+                    posn.data += delta;
+                }
+                return posn;
+            });
+        }
+
+    }; // class WDLFileWriter
+
+
+
     class DataFileReader {
 
     private: // =============================================== MEMBER VARIABLES
@@ -148,19 +579,44 @@ namespace dzc4 {
         std::filesystem::path data_path;
         std::uintmax_t data_size;
         std::ifstream data_stream;
+        bool encoded;
+        std::vector<unsigned char> block;
+        const unsigned char *block_ptr;
+        std::uint32_t block_remaining;
+        BoardWord last_data;
 
     public: // ===================================================== CONSTRUCTOR
 
-        explicit DataFileReader(const std::string &path_str) {
+        explicit DataFileReader(const std::string &path_str) :
+                encoded(false), block_ptr(nullptr),
+                block_remaining(0), last_data(0) {
             data_path = path_str;
             assert_file_exists(data_path);
             data_size = std::filesystem::file_size(data_path);
-            exit_if(data_size % sizeof(CompressedPosition64) != 0,
-                    "ERROR: Data file ", data_path, " is malformed.");
-            data_size /= sizeof(CompressedPosition64);
             data_stream.open(data_path, std::ios::binary | std::ios::in);
             exit_if(data_stream.fail(),
                     "ERROR: Failed to open data file ", data_path, ".");
+            char magic[sizeof(DATA_FILE_MAGIC)] = {};
+            if (data_size >= sizeof(DATA_FILE_MAGIC) + 16) {
+                data_stream.read(magic, sizeof(magic));
+                encoded = std::equal(magic, magic + sizeof(magic),
+                                     DATA_FILE_MAGIC);
+            }
+            if (encoded) {
+                // The total count is stored in the last eight bytes.
+                data_stream.seekg(-8, std::ios::end);
+                std::uint64_t total_count;
+                data_stream.read(char_ptr_to(total_count), 8);
+                data_stream.seekg(sizeof(DATA_FILE_MAGIC), std::ios::beg);
+                exit_if(data_stream.fail(),
+                        "ERROR: Data file ", data_path, " is malformed.");
+                data_size = total_count;
+            } else {
+                exit_if(data_size % sizeof(SolverKey) != 0,
+                        "ERROR: Data file ", data_path, " is malformed.");
+                data_size /= sizeof(SolverKey);
+                data_stream.seekg(0, std::ios::beg);
+            }
             std::cout << "Successfully opened data file " << data_path
                       << ". Found " << data_size << " positions." << std::endl;
         }
@@ -181,11 +637,71 @@ namespace dzc4 {
 
         std::uintmax_t size() const { return data_size; }
 
+    private: // ======================================================= DECODING
+
+        // Loads the next block into memory. At the terminating block, puts
+        // the stream into the same eof/fail state that a raw read past the
+        // end of the file would.
+        bool load_block() {
+            std::uint32_t num_bytes = 0;
+            data_stream.read(char_ptr_to(block_remaining),
+                             sizeof(block_remaining));
+            data_stream.read(char_ptr_to(num_bytes), sizeof(num_bytes));
+            exit_if(data_stream.fail(),
+                    "ERROR: Data file ", data_path, " is malformed.");
+            if (block_remaining == 0) {
+                data_stream.setstate(std::ios::eofbit | std::ios::failbit);
+                return false;
+            }
+            block.resize(num_bytes);
+            data_stream.read(char_ptr_to(block.data()),
+                             static_cast<std::streamsize>(num_bytes));
+            exit_if(data_stream.fail(),
+                    "ERROR: Data file ", data_path, " is malformed.");
+            block_ptr = block.data();
+            // The first position of a block must follow the last position of
+            // the previous one. (Before the first block, last_data is zero,
+            // which is less than every valid position.)
+            BoardWord first_data;
+            exit_if(!read_varint(block_ptr, block_end(), first_data)
+                    || first_data <= last_data,
+                    "ERROR: Data file ", data_path, " is malformed.");
+            last_data = first_data;
+            return true;
+        }
+
+        const unsigned char *block_end() const {
+            return block.data() + block.size();
+        }
+
+        // Positions are strictly increasing, so every delta must be nonzero
+        // and must not wrap around, and the last position of a block must
+        // end exactly at the end of its payload.
+        bool decode(SolverKey &posn) {
+            if (block_remaining == 0) {
+                if (!load_block()) return false;
+            } else {
+                BoardWord delta;
+                exit_if(!read_varint(block_ptr, block_end(), delta)
+                        || delta == 0 || last_data + delta < last_data,
+                        "ERROR: Data file ", data_path, " is malformed.");
+                last_data += delta;
+            }
+            exit_if(--block_remaining == 0 && block_ptr != block_end(),
+                    "ERROR: Data file ", data_path, " is malformed.");
+            posn.data = last_data;
+            return true;
+        }
+
     public: // ======================================= STREAM INSERTION OPERATOR
 
-        DataFileReader &operator>>(CompressedPosition64 &posn) {
+        DataFileReader &operator>>(SolverKey &posn) {
+            if (encoded) {
+                if (data_stream) decode(posn);
+                return *this;
+            }
             char *posn_ptr = char_ptr_to(posn);
-            data_stream.read(posn_ptr, sizeof(CompressedPosition64));
+            data_stream.read(posn_ptr, sizeof(SolverKey));
             return *this;
         }
 
@@ -199,20 +715,45 @@ namespace dzc4 {
 
         std::filesystem::path table_path;
         std::uintmax_t table_size;
+        std::uintmax_t remaining;
+        unsigned table_prune_depth;
         std::ifstream table_stream;
 
     public: // ===================================================== CONSTRUCTOR
 
+        // Accepts distance tables both with and without a header (see
+        // TableHeader.hpp). Only the data section is read.
         explicit TableFileReader(const std::string &path_str) {
             table_path = path_str;
             assert_file_exists(table_path);
-            table_size = std::filesystem::file_size(table_path);
-            exit_if(table_size % (sizeof(CompressedPosition64) + 1) != 0,
-                    "ERROR: Table file ", table_path, " is malformed.");
-            table_size /= sizeof(CompressedPosition64) + 1;
+            const std::uintmax_t file_size =
+                    std::filesystem::file_size(table_path);
             table_stream.open(table_path, std::ios::binary | std::ios::in);
             exit_if(table_stream.fail(),
                     "ERROR: Failed to open table file ", table_path, ".");
+            std::vector<char> header_data(TABLE_HEADER_SIZE);
+            table_stream.read(header_data.data(), TABLE_HEADER_SIZE);
+            table_stream.clear();
+            if (TableHeader::is_present(header_data.data(),
+                    static_cast<std::size_t>(table_stream.gcount()))) {
+                const TableHeader header = TableHeader::read(
+                        table_path.c_str(), header_data.data(), file_size);
+                exit_if(header.encoding != TableEncoding::DISTANCE ||
+                        header.key_size != sizeof(SolverKey),
+                        "ERROR: Table file ", table_path,
+                        " does not hold distances for this board.");
+                table_size = header.num_entries;
+                table_prune_depth = header.prune_depth;
+                table_stream.seekg(static_cast<std::streamoff>(
+                        header.data_offset), std::ios::beg);
+            } else {
+                exit_if(file_size % (sizeof(SolverKey) + 1) != 0,
+                        "ERROR: Table file ", table_path, " is malformed.");
+                table_size = file_size / (sizeof(SolverKey) + 1);
+                table_prune_depth = 0;
+                table_stream.seekg(0, std::ios::beg);
+            }
+            remaining = table_size;
             std::cout << "Successfully opened table file " << table_path
                       << ". Found " << table_size << " positions." << std::endl;
         }
@@ -230,11 +771,18 @@ namespace dzc4 {
 
         std::uintmax_t size() const { return table_size; }
 
+        unsigned prune_depth() const { return table_prune_depth; }
+
     public: // ======================================= STREAM INSERTION OPERATOR
 
-        TableFileReader &read(CompressedPosition64 &posn, int &score) {
+        TableFileReader &read(SolverKey &posn, int &score) {
+            if (remaining == 0) {
+                table_stream.setstate(std::ios::eofbit | std::ios::failbit);
+                return *this;
+            }
+            --remaining;
             char *posn_ptr = char_ptr_to(posn);
-            table_stream.read(posn_ptr, sizeof(CompressedPosition64));
+            table_stream.read(posn_ptr, sizeof(SolverKey));
             signed char char_score;
             char *score_ptr = char_ptr_to(char_score);
             table_stream.read(score_ptr, 1);
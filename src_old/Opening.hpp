@@ -0,0 +1,47 @@
+#ifndef DZC4_OPENING_HPP_INCLUDED
+#define DZC4_OPENING_HPP_INCLUDED
+
+// C++ standard library headers
+#include <cstddef> // for std::size_t
+#include <string>
+
+// Project-specific headers
+#include "Constants.hpp"
+#include "FileNames.hpp" // for dzc4::SolverKey, dzc4::SolverPosition
+#include "Position.hpp"
+#include "Utilities.hpp"
+
+namespace dzc4 {
+
+
+    // Plays out an opening given as a string of column labels, '1' through
+    // '9' followed by 'a' through 'g' for boards with more than nine columns,
+    // exiting with an error if any move is illegal or the game ends early.
+    inline SolverKey play_opening(const std::string &opening) {
+        SolverKey posn;
+        for (std::size_t i = 0; i < opening.size(); ++i) {
+            const char label = opening[i];
+            const unsigned col =
+                    ('1' <= label && label <= '9') ? label - '1'
+                    : ('a' <= label && label <= 'g') ? label - 'a' + 9
+                    : NUM_COLS;
+            exit_if(col >= NUM_COLS, "ERROR: Invalid column '", label,
+                    "' in opening ", opening, ".");
+            const SolverKey next = (i % 2 == 0)
+                    ? posn.move<Player::WHITE, NUM_ROWS>(col)
+                    : posn.move<Player::BLACK, NUM_ROWS>(col);
+            exit_if(!next, "ERROR: Column ", label, " is already full "
+                    "before move ", i + 1, " of opening ", opening, ".");
+            posn = next;
+            const SolverPosition board = posn.decompress();
+            exit_if(board.won<Player::WHITE>() || board.won<Player::BLACK>(),
+                    "ERROR: The game is already over after move ", i + 1,
+                    " of opening ", opening, ".");
+        }
+        return posn;
+    }
+
+
+} // namespace dzc4
+
+#endif // DZC4_OPENING_HPP_INCLUDED
@@ -0,0 +1,95 @@
+#ifndef DZC4_PHASE_STATS_HPP_INCLUDED
+#define DZC4_PHASE_STATS_HPP_INCLUDED
+
+// C++ standard library headers
+#include <chrono>   // for std::chrono::steady_clock
+#include <fstream>  // for std::ifstream, std::ofstream
+#include <iostream> // for std::cout, std::endl
+#include <string>   // for std::string
+
+namespace dzc4 {
+
+
+    // PhaseStats measures one phase of a solve (a single chunkstep, mergestep,
+    // endstep or backstep) and prints a single line summarizing it when it
+    // goes out of scope:
+    //
+    //     PHASE <name> <ply> seconds=... rchar=... wchar=... read_bytes=...
+    //           write_bytes=... peak_rss_kb=...
+    //
+    // rchar and wchar count bytes passed through read() and write() calls,
+    // while read_bytes and write_bytes count bytes that actually reached
+    // storage (including page faults on memory-mapped tables). The peak RSS
+    // is reset at the start of every phase via /proc/self/clear_refs, so it
+    // reflects that phase alone. These lines are parsed by harness/.
+
+    class PhaseStats {
+
+    private: // =============================================== MEMBER VARIABLES
+
+        std::string name;
+        unsigned ply;
+        std::chrono::steady_clock::time_point start_time;
+        unsigned long long rchar, wchar, read_bytes, write_bytes;
+
+    public: // ===================================================== CONSTRUCTOR
+
+        explicit PhaseStats(const std::string &phase_name, unsigned phase_ply) :
+                name(phase_name), ply(phase_ply) {
+            std::ofstream("/proc/self/clear_refs") << "5";
+            read_io(rchar, wchar, read_bytes, write_bytes);
+            start_time = std::chrono::steady_clock::now();
+        }
+
+        PhaseStats(const PhaseStats &) = delete;
+        PhaseStats &operator=(const PhaseStats &) = delete;
+
+        ~PhaseStats() {
+            const std::chrono::duration<double> elapsed =
+                    std::chrono::steady_clock::now() - start_time;
+            unsigned long long rc, wc, rb, wb;
+            read_io(rc, wc, rb, wb);
+            std::cout << "PHASE " << name << ' ' << ply
+                      << " seconds=" << elapsed.count()
+                      << " rchar=" << rc - rchar
+                      << " wchar=" << wc - wchar
+                      << " read_bytes=" << rb - read_bytes
+                      << " write_bytes=" << wb - write_bytes
+                      << " peak_rss_kb=" << peak_rss_kb() << std::endl;
+        }
+
+    private: // ==================================================== /proc FILES
+
+        static void read_io(unsigned long long &rc, unsigned long long &wc,
+                            unsigned long long &rb, unsigned long long &wb) {
+            rc = wc = rb = wb = 0;
+            std::ifstream io("/proc/self/io");
+            std::string key;
+            unsigned long long value;
+            while (io >> key >> value) {
+                if (key == "rchar:") rc = value;
+                else if (key == "wchar:") wc = value;
+                else if (key == "read_bytes:") rb = value;
+                else if (key == "write_bytes:") wb = value;
+            }
+        }
+
+        static unsigned long long peak_rss_kb() {
+            std::ifstream status("/proc/self/status");
+            std::string key;
+            while (status >> key) {
+                if (key == "VmHWM:") {
+                    unsigned long long value;
+                    status >> value;
+                    return value;
+                }
+                status.ignore(256, '\n');
+            }
+            return 0;
+        }
+
+    }; // class PhaseStats
+
+} // namespace dzc4
+
+#endif // DZC4_PHASE_STATS_HPP_INCLUDED
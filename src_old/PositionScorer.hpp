@@ -0,0 +1,117 @@
+#ifndef DZC4_POSITION_SCORER_HPP_INCLUDED
+#define DZC4_POSITION_SCORER_HPP_INCLUDED
+
+// C++ standard library headers
+#include <climits> // for INT_MIN
+#include <optional> // for std::optional
+#include <string>
+
+// Project-specific headers
+#include "Constants.hpp"
+#include "FileNames.hpp" // for filename_tag, dzc4::SolverKey
+#include "OpeningBook.hpp"
+#include "Position.hpp"
+#include "SparseTables.hpp"
+#include "Utilities.hpp"
+
+// The opening book compiled into this program, if any: the file made by
+// makebook, whose path is given by defining DZC4_OPENING_BOOK.
+#ifdef DZC4_OPENING_BOOK
+#include DZC4_OPENING_BOOK
+constexpr dzc4::OpeningBook<BoardWord> OPENING_BOOK(OPENING_BOOK_KEYS,
+                                                    OPENING_BOOK_SCORES);
+#else
+constexpr unsigned OPENING_BOOK_PLIES = 0;
+constexpr dzc4::OpeningBook<BoardWord> OPENING_BOOK({}, {});
+#endif
+
+static_assert(OPENING_BOOK.is_valid(), "Opening book is malformed.");
+
+namespace dzc4 {
+
+
+    // PositionScorer scores a position of any ply from the cheapest source
+    // that has it: the compiled-in opening book, then the table of its ply,
+    // then the DEPTH + 1 search, and failing all of those, reconstruction
+    // from the tables of later plies (see SparseTables.hpp). The tables are
+    // only opened once a position is not in the book, so positions that the
+    // book covers are scored without touching any file.
+
+    class PositionScorer {
+
+    public: // ========================================================== TYPES
+
+        enum class Source { BOOK, TABLE, SEARCH, RECONSTRUCTION };
+
+        static constexpr unsigned LAST_PLY = SparseTables::LAST_PLY;
+
+    private: // =============================================== MEMBER VARIABLES
+
+        std::string table_tag;
+        std::optional<SparseTables> tables;
+        SparseTables::Cache cache;
+
+    public: // ===================================================== CONSTRUCTOR
+
+        // The tag selects the tables to fall back on (see SparseTables).
+        explicit PositionScorer(const std::string &tag = filename_tag) :
+                table_tag(tag), cache(RECONSTRUCTION_CACHE_SIZE) {}
+
+        PositionScorer(const PositionScorer &) = delete;
+        PositionScorer &operator=(const PositionScorer &) = delete;
+
+    public: // ======================================================== SCORING
+
+        static const char *name(Source source) {
+            switch (source) {
+                case Source::BOOK: return "book";
+                case Source::TABLE: return "table";
+                case Source::SEARCH: return "search";
+                case Source::RECONSTRUCTION: return "reconstruction";
+            }
+            return "unknown";
+        }
+
+        // Scores posn, a position of the given ply with PLAYER to move, and
+        // stores where the score came from in source, if given.
+        template <Player PLAYER>
+        int score(SolverKey posn, unsigned ply, Source *source = nullptr) {
+            const auto from = [source](Source found_in) {
+                if (source) *source = found_in;
+            };
+            if (ply < OPENING_BOOK_PLIES) {
+                if (const std::optional<int> book_score =
+                        OPENING_BOOK.find(posn)) {
+                    from(Source::BOOK);
+                    return *book_score;
+                }
+            }
+            if (ply <= LAST_PLY) {
+                if (!tables) tables.emplace(1, table_tag);
+                if (const SparseTables::Table *table = tables->table(ply)) {
+                    if (const std::optional<int> table_score =
+                            table->find_score(posn)) {
+                        from(Source::TABLE);
+                        return *table_score;
+                    }
+                }
+            }
+            const int searched = posn.decompress().calculate_score<
+                    PLAYER, NUM_ROWS, NUM_COLS, DEPTH + 1>();
+            if (searched != INT_MIN) {
+                from(Source::SEARCH);
+                return searched;
+            }
+            // The search is always conclusive beyond the last ply, so the
+            // tables have been opened.
+            exit_if(tables->stored_bytes() == 0, "ERROR: Found no tables.");
+            from(Source::RECONSTRUCTION);
+            return tables->reconstruct<PLAYER>(posn, ply, cache);
+        }
+
+    }; // class PositionScorer
+
+
+} // namespace dzc4
+
+#endif // DZC4_POSITION_SCORER_HPP_INCLUDED
@@ -0,0 +1,132 @@
+#ifndef DZC4_SPARSE_TABLES_HPP_INCLUDED
+#define DZC4_SPARSE_TABLES_HPP_INCLUDED
+
+// C++ standard library headers
+#include <climits> // for INT_MIN
+#include <cstddef> // for std::size_t
+#include <cstdint> // for std::uintmax_t
+#include <filesystem>
+#include <optional> // for std::optional
+#include <string>
+#include <vector>
+
+// Project-specific headers
+#include "Constants.hpp"
+#include "FileNames.hpp" // for tabfilename, dzc4::SolverKey
+#include "BloomFilter.hpp"
+#include "LRUCache.hpp"
+#include "MemoryMappedTable.hpp"
+#include "Position.hpp"
+
+namespace dzc4 {
+
+
+    struct SolverKeyHash {
+        std::size_t operator()(const SolverKey &key) const noexcept {
+            return static_cast<std::size_t>(BloomFilter::hash(key.data));
+        }
+    };
+
+
+    // SparseTables scores positions of any ply from the tables of only some
+    // plies (e.g., a solve with TABLE_STRIDE > 1). A position is looked up in
+    // the table of its ply if there is one. If its ply has no table, or the
+    // table does not hold it, it is scored by the DEPTH + 1 search if that is
+    // conclusive (which it always is from the last ply on), and failing that,
+    // reconstructed from the scores of its children by the same rules that
+    // backstep applies (see MemoryMappedTable::evaluate_with), recursing ply
+    // by ply until the children are found in a table. With tables every k
+    // plies, a reconstruction of a position that a full solve reaches thus
+    // visits at most NUM_COLS^(k - 1) positions. (A position that the solve
+    // never reached, e.g., after an opening that passes up an immediate win,
+    // is missing from every table and is reconstructed from the last ply
+    // up.) Reconstructed scores are kept in a caller-supplied Cache, so
+    // that a SparseTables object can be shared between threads that each
+    // have their own cache.
+
+    class SparseTables {
+
+    public: // ========================================================== TYPES
+
+        using Table = MemoryMappedTable<BoardWord>;
+        using Cache = LRUCache<SolverKey, int, SolverKeyHash>;
+
+        static constexpr unsigned LAST_PLY = NUM_ROWS * NUM_COLS - DEPTH;
+
+    private: // =============================================== MEMBER VARIABLES
+
+        std::vector<std::optional<Table>> tables;
+        std::uintmax_t table_bytes;
+
+    public: // ===================================================== CONSTRUCTOR
+
+        // Opens the table of every ply that is a multiple of stride, if it
+        // exists. (A stride of 1 uses every table there is.) The tag selects
+        // the tables of a subtree solve; an empty tag selects the tables of a
+        // full solve.
+        explicit SparseTables(unsigned stride = 1,
+                              const std::string &tag = filename_tag) :
+                tables(LAST_PLY + 1), table_bytes(0) {
+            for (unsigned ply = 0; ply <= LAST_PLY; ply += stride) {
+                const std::string path = tabfilename(ply, tag);
+                if (!std::filesystem::exists(path)) continue;
+                tables[ply].emplace(path);
+                tables[ply]->expect(NUM_ROWS, NUM_COLS, ply, DEPTH);
+                table_bytes += std::filesystem::file_size(path);
+            }
+        }
+
+        SparseTables(const SparseTables &) = delete;
+        SparseTables &operator=(const SparseTables &) = delete;
+
+    public: // ======================================================= ACCESSORS
+
+        bool is_stored(unsigned ply) const {
+            return ply <= LAST_PLY && tables[ply].has_value();
+        }
+
+        // Returns the table of ply, or null if it has none.
+        const Table *table(unsigned ply) const {
+            return is_stored(ply) ? &*tables[ply] : nullptr;
+        }
+
+        // Returns the total size of the tables in use, in bytes.
+        std::uintmax_t stored_bytes() const { return table_bytes; }
+
+    public: // ======================================================== SCORING
+
+        template <Player PLAYER>
+        int score(SolverKey posn, unsigned ply, Cache &cache) const {
+            if (is_stored(ply)) {
+                if (const std::optional<int> stored =
+                        tables[ply]->find_score(posn)) {
+                    return *stored;
+                }
+            }
+            if (const std::optional<int> cached = cache.find(posn)) {
+                return *cached;
+            }
+            const int searched = posn.decompress().calculate_score<
+                    PLAYER, NUM_ROWS, NUM_COLS, DEPTH + 1>();
+            if (searched != INT_MIN) return searched;
+            const int result = reconstruct<PLAYER>(posn, ply, cache);
+            cache.insert(posn, result);
+            return result;
+        }
+
+        // Scores posn from the scores of its children, whether or not its own
+        // ply has a table.
+        template <Player PLAYER>
+        int reconstruct(SolverKey posn, unsigned ply, Cache &cache) const {
+            return Table::evaluate_with<PLAYER, NUM_ROWS, NUM_COLS>(posn,
+                    [&](unsigned, SolverKey child) {
+                return score<other(PLAYER)>(child, ply + 1, cache);
+            });
+        }
+
+    }; // class SparseTables
+
+
+} // namespace dzc4
+
+#endif // DZC4_SPARSE_TABLES_HPP_INCLUDED
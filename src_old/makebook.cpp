@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Constants.hpp"
+#include "FileNames.hpp"
+#include "Position.hpp"
+#include "SparseTables.hpp"
+
+// Scores every position that can arise in plies 0 through NUM_PLIES - 1 of a
+// game that is still going on, and writes the scores as an opening book (see
+// OpeningBook.hpp) to OUTPUT as C++ source:
+//
+//     makebook 8 OpeningBook.inc
+//     g++ ... -DDZC4_OPENING_BOOK='"OpeningBook.inc"' src_old/query.cpp
+//
+// Positions are scored with SparseTables::score, which also covers the
+// positions that the solver never stored in a table: those it resolved by
+// search (or pruned), whose scores the search recovers, and those it never
+// reached at all, such as the positions after a move that passes up an
+// immediate win, whose scores are reconstructed from their children. A query
+// for any legal opening of up to NUM_PLIES - 1 moves therefore never has to
+// touch a table file. Tables need not exist for every ply (see TABLE_STRIDE).
+// The book records the board and key width it was made for, and refuses to
+// compile into a program built for any others.
+
+using dzc4::Player;
+
+// Appends every child of posn in which the game is not over yet.
+template <Player PLAYER>
+void expand(dzc4::SolverKey posn, std::vector<dzc4::SolverKey> &children) {
+    const dzc4::SolverPosition decompressed = posn.decompress();
+    for (BoardWord rest = posn.moves<NUM_ROWS, NUM_COLS>(); rest;
+         rest &= rest - 1) {
+        const BoardWord piece = rest & -rest;
+        if (!decompressed.wins_with<PLAYER>(piece)) {
+            children.push_back(posn.play<PLAYER>(piece));
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+
+    dzc4::exit_if(argc != 3, "Usage: ", argv[0], " NUM_PLIES OUTPUT");
+    const unsigned num_plies = static_cast<unsigned>(std::stoul(argv[1]));
+    const std::string output_path = argv[2];
+    dzc4::exit_if(num_plies == 0
+                  || num_plies > NUM_ROWS * NUM_COLS - DEPTH + 1,
+                  "ERROR: NUM_PLIES must be between 1 and ",
+                  NUM_ROWS * NUM_COLS - DEPTH + 1, ".");
+
+    const dzc4::SparseTables tables;
+    dzc4::exit_if(tables.stored_bytes() == 0, "ERROR: Found no tables.");
+    dzc4::SparseTables::Cache cache(RECONSTRUCTION_CACHE_SIZE);
+
+    std::vector<std::pair<BoardWord, int>> entries;
+    std::vector<dzc4::SolverKey> posns = {dzc4::SolverKey()};
+    for (unsigned ply = 0; ply < num_plies; ++ply) {
+        for (const dzc4::SolverKey posn : posns) {
+            entries.emplace_back(posn.data, ply % 2 == 0
+                    ? tables.score<Player::WHITE>(posn, ply, cache)
+                    : tables.score<Player::BLACK>(posn, ply, cache));
+        }
+        std::cout << "Scored " << posns.size() << " positions at ply " << ply
+                  << "." << std::endl;
+        std::vector<dzc4::SolverKey> children;
+        for (const dzc4::SolverKey posn : posns) {
+            if (ply % 2 == 0) expand<Player::WHITE>(posn, children);
+            else expand<Player::BLACK>(posn, children);
+        }
+        std::sort(children.begin(), children.end());
+        children.erase(std::unique(children.begin(), children.end()),
+                       children.end());
+        posns = std::move(children);
+    }
+    // Positions from different plies have different numbers of pieces, and
+    // so never share a key.
+    std::sort(entries.begin(), entries.end());
+
+    std::ofstream output(output_path);
+    dzc4::exit_if(!output, "ERROR: Failed to create ", output_path, ".");
+    output << "// Opening book for plies 0 through " << num_plies - 1
+           << " of the " << NUM_COLS << "x" << NUM_ROWS << " board,\n"
+           << "// generated by makebook. Do not edit.\n\n"
+           << "static_assert(NUM_COLS == " << NUM_COLS
+           << " && NUM_ROWS == " << NUM_ROWS << ",\n"
+           << "              \"This opening book was made for a "
+           << NUM_COLS << "x" << NUM_ROWS << " board.\");\n"
+           << "static_assert(sizeof(BoardWord) == " << sizeof(BoardWord)
+           << ",\n"
+           << "              \"This opening book was made with "
+           << 8 * sizeof(BoardWord) << "-bit keys.\");\n\n"
+           << "constexpr unsigned OPENING_BOOK_PLIES = " << num_plies
+           << ";\n\n"
+           << "constexpr BoardWord OPENING_BOOK_KEYS[] = {\n"
+           << std::hex << std::setfill('0');
+    for (const auto &[key, score] : entries) {
+        // There are no 128-bit integer literals, so wide keys are built from
+        // their two halves.
+        const std::uint64_t low_word = static_cast<std::uint64_t>(key);
+        if constexpr (sizeof(BoardWord) > 8) {
+            output << "    BoardWord(0x" << std::setw(16)
+                   << static_cast<std::uint64_t>(key >> 64) << ") << 64 | 0x"
+                   << std::setw(16) << low_word << ",\n";
+        } else {
+            output << "    0x" << std::setw(16) << low_word << ",\n";
+        }
+    }
+    output << "};\n\n"
+           << "constexpr signed char OPENING_BOOK_SCORES[] = {" << std::dec;
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        output << (i % 16 == 0 ? "\n    " : " ") << entries[i].second << ",";
+    }
+    output << "\n};\n";
+    output.close();
+    dzc4::exit_if(!output, "ERROR: Failed to write to ", output_path, ".");
+    std::cout << "Wrote " << entries.size() << " positions to opening book "
+              << output_path << "." << std::endl;
+
+    return EXIT_SUCCESS;
+
+}
@@ -0,0 +1,47 @@
+#include <iostream>
+#include <string>
+
+#include "Constants.hpp"
+#include "FileNames.hpp"
+#include "Opening.hpp"
+#include "PositionScorer.hpp"
+#include "Position.hpp"
+
+// Prints the score of each opening given on the command line (see
+// Opening.hpp; an empty string is the empty board), from the point of view
+// of the player to move:
+//
+//     OPENING <opening> SCORE <score> FROM <book|table|search|reconstruction>
+//
+// Positions are scored by a PositionScorer, which looks in the compiled-in
+// opening book first, if there is one, so that no table file is opened for
+// openings that it covers. The book is the file made by makebook, whose path
+// is given by defining DZC4_OPENING_BOOK. Otherwise, the tables are mapped
+// (once) and the table for the opening's ply is searched. A position that is
+// not in it (e.g., because the solve did not keep that table; see
+// TABLE_STRIDE) is scored by search if possible, and otherwise reconstructed
+// from the tables of later plies.
+
+using dzc4::Player;
+
+int main(int argc, char **argv) {
+
+    dzc4::exit_if(argc < 2, "Usage: ", argv[0], " OPENING...");
+    dzc4::PositionScorer scorer;
+
+    for (int arg = 1; arg < argc; ++arg) {
+        const std::string opening = argv[arg];
+        const dzc4::SolverKey posn = dzc4::play_opening(opening);
+        const unsigned ply = static_cast<unsigned>(opening.size());
+        dzc4::PositionScorer::Source source;
+        const int score = (ply % 2 == 0)
+                ? scorer.score<Player::WHITE>(posn, ply, &source)
+                : scorer.score<Player::BLACK>(posn, ply, &source);
+        std::cout << "OPENING " << opening << " SCORE " << score
+                  << " FROM " << dzc4::PositionScorer::name(source)
+                  << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+
+}
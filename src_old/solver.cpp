@@ -1,16 +1,23 @@
 #include <algorithm>
+#include <cstdint>
+#include <cstdio>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <string>
 #include <vector>
 
 #include "Constants.hpp"
 #include "FileNames.hpp"
-#include "BitBoard64.hpp"
-#include "Position128.hpp"
+#include "BitBoard.hpp"
+#include "Position.hpp"
 #include "MemoryMappedTable.hpp"
+#include "Opening.hpp"
+#include "PhaseStats.hpp"
+#include "PositionScorer.hpp"
+#include "ThreadPool.hpp"
 
-void writechunk(std::vector<dzc4::CompressedPosition64> &posns,
+void writechunk(std::vector<dzc4::SolverKey> &posns,
                 unsigned ply, unsigned chunk) {
     std::sort(posns.begin(), posns.end());
     posns.erase(std::unique(posns.begin(), posns.end()), posns.end());
@@ -20,31 +27,49 @@ void writechunk(std::vector<dzc4::CompressedPosition64> &posns,
 
 using dzc4::Player, dzc4::Evaluation;
 
+// Moves are generated directly on the compressed key: each child's key is a
+// single addition, and the parent is decompressed only once for the shallow
+// evaluate<DEPTH> search of its children. Every position in a ply file is
+// unresolved, so neither player has four in a row yet, and a child can only
+// be won through the piece that was just placed.
+template <Player PLAYER>
+void expand(dzc4::SolverKey posn,
+            std::vector<dzc4::SolverKey> &posns) {
+    const dzc4::SolverPosition decompressed = posn.decompress();
+    for (BoardWord rest = posn.moves<NUM_ROWS, NUM_COLS>(); rest;
+         rest &= rest - 1) {
+        const BoardWord piece = rest & -rest;
+        if (decompressed.wins_with<PLAYER>(piece)) continue;
+        const dzc4::SolverPosition next_posn =
+            decompressed.place<PLAYER>(piece);
+        const Evaluation ev = next_posn.evaluate_unwon<
+                dzc4::other(PLAYER), NUM_ROWS, NUM_COLS, DEPTH>();
+        if (ev == Evaluation::UNKNOWN) {
+            posns.push_back(posn.play<PLAYER>(piece));
+        }
+    }
+}
+
 void chunkstep(unsigned ply) {
     dzc4::DataFileReader reader(ply);
     double total = reader.size();
-    dzc4::CompressedPosition64 posn;
-    std::vector<dzc4::CompressedPosition64> posns;
+    dzc4::SolverKey posn;
+    std::vector<dzc4::SolverKey> posns;
     unsigned long long int count = 0;
     unsigned chunk = 0;
     while (reader >> posn) {
-        for (unsigned col = 0; col < NUM_COLS; ++col) {
-            if (const dzc4::Position128 next_posn = ply % 2 == 0
-                    ? posn.decompress().move<Player::WHITE, NUM_ROWS>(col)
-                    : posn.decompress().move<Player::BLACK, NUM_ROWS>(col)) {
-                const Evaluation ev = ply % 2 == 0
-                    ? next_posn.evaluate<Player::BLACK, NUM_ROWS, NUM_COLS, DEPTH>()
-                    : next_posn.evaluate<Player::WHITE, NUM_ROWS, NUM_COLS, DEPTH>();
-                if (ev == Evaluation::UNKNOWN) posns.emplace_back(next_posn);
-            }
-        }
+        if (ply % 2 == 0) expand<Player::WHITE>(posn, posns);
+        else expand<Player::BLACK>(posn, posns);
         if (++count % CHUNK_SIZE == 0) {
             std::cout << "Expanded " << count << " positions ("
                       << 100 * (count / total) << "%)." << std::endl;
             writechunk(posns, ply + 1, chunk++);
         }
     }
-    if (!posns.empty()) {
+    // A subtree solve may run out of unresolved positions before the last
+    // ply, in which case an empty chunk is written so that every later ply
+    // still gets a (likewise empty) ply file and table.
+    if (!posns.empty() || chunk == 0) {
         std::cout << "Expanded " << count << " positions ("
                   << 100 * (count / total) << "%)." << std::endl;
         writechunk(posns, ply + 1, chunk);
@@ -56,7 +81,7 @@ void chunkstep(unsigned ply) {
 // ========================================================================== //
 
 bool readnext(std::vector<dzc4::DataFileReader> &chunk_readers,
-              std::vector<dzc4::CompressedPosition64> &front_buffer,
+              std::vector<dzc4::SolverKey> &front_buffer,
               std::size_t index) {
     chunk_readers[index] >> front_buffer[index];
     if (chunk_readers[index].eof()) {
@@ -71,12 +96,12 @@ bool readnext(std::vector<dzc4::DataFileReader> &chunk_readers,
 
 void merge(std::vector<dzc4::DataFileReader> &chunkfiles,
            dzc4::DataFileWriter &plyfile) {
-    std::vector<dzc4::CompressedPosition64> front(chunkfiles.size());
+    std::vector<dzc4::SolverKey> front(chunkfiles.size());
     for (std::size_t i = 0; i < chunkfiles.size(); ++i) {
         if (!readnext(chunkfiles, front, i)) --i;
     }
     while (!chunkfiles.empty()) {
-        const dzc4::CompressedPosition64 minpos =
+        const dzc4::SolverKey minpos =
             *std::min_element(front.begin(), front.end());
         plyfile << minpos;
         for (std::size_t i = 0; i < chunkfiles.size(); ++i) {
@@ -106,7 +131,8 @@ void mergestep(unsigned ply) {
     merge(chunkfiles, writer);
     for (unsigned chunk = 0; chunk < count; ++chunk) {
         const std::string chunkname = chunkfilename(ply, chunk);
-        std::remove(chunkname.c_str());
+        dzc4::exit_if(std::remove(chunkname.c_str()) != 0,
+                      "ERROR: Failed to delete chunk file ", chunkname, ".");
     }
 }
 
@@ -114,78 +140,221 @@ void mergestep(unsigned ply) {
 // |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||| //
 // ========================================================================== //
 
-void endstep() {
+// Reads up to EVALUATION_BATCH_SIZE positions into batch, and returns false
+// once the reader has no positions left.
+bool readbatch(dzc4::DataFileReader &reader,
+               std::vector<dzc4::SolverKey> &batch) {
+    batch.resize(EVALUATION_BATCH_SIZE);
+    std::size_t size = 0;
+    while (size < batch.size() && reader >> batch[size]) ++size;
+    batch.resize(size);
+    return size != 0;
+}
+
+// Returns true if posn, whose score is score, may be left out of its table
+// (see PRUNE_TABLES in Constants.hpp).
+template <Player PLAYER>
+bool prunable(dzc4::SolverKey posn, int score) {
+    if constexpr (!PRUNE_TABLES) {
+        return false;
+    } else {
+        return posn.decompress().calculate_score<
+                PLAYER, NUM_ROWS, NUM_COLS, DEPTH + 1>() == score;
+    }
+}
+
+using LookupCursor = dzc4::MemoryMappedTable<BoardWord>::LookupCursor;
+
+// Scores every position of a ply file. Each batch is spread across the
+// threads of the pool, which share the read-only state captured by score, and
+// every score is written at the index of its position, so the table comes out
+// in the order of the ply file no matter which thread scored what. Each
+// contiguous range of a batch gets its own LookupCursor, which score may use
+// to speed up table lookups for consecutive positions.
+template <typename SCORE>
+void evaluateply(unsigned ply, dzc4::DataFileReader &reader,
+                 dzc4::TableFileWriter &writer, dzc4::ThreadPool &pool,
+                 const SCORE &score) {
+    double total = reader.size();
+    std::vector<dzc4::SolverKey> batch;
+    unsigned long long int count = 0;
+    while (readbatch(reader, batch)) {
+        pool.parallel_for_ranges(0, batch.size(),
+                                 [&](std::size_t begin, std::size_t end) {
+            LookupCursor cursor;
+            for (std::size_t i = begin; i < end; ++i) {
+                const int posn_score = score(batch[i], cursor);
+                if (ply % 2 == 0
+                        ? prunable<Player::WHITE>(batch[i], posn_score)
+                        : prunable<Player::BLACK>(batch[i], posn_score)) {
+                    writer.prune(count + i, batch[i]);
+                } else {
+                    writer.write(count + i, batch[i], posn_score);
+                }
+            }
+        });
+        count += batch.size();
+        if (count % CHUNK_SIZE == 0) {
+            std::cout << "Evaluated " << count << " positions ("
+                      << 100 * (count / total) << "%)." << std::endl;
+        }
+    }
+    std::cout << "Evaluated " << count << " positions ("
+              << 100 * (count / total) << "%)." << std::endl;
+}
+
+void endstep(dzc4::ThreadPool &pool) {
     constexpr unsigned ply = NUM_ROWS * NUM_COLS - DEPTH;
     {
         dzc4::DataFileReader reader(ply);
-        double total = reader.size();
-        dzc4::TableFileWriter writer(ply);
-        dzc4::CompressedPosition64 posn;
-        unsigned long long int count = 0;
-        while (reader >> posn) {
-            const int score = ply % 2 == 0
-                    ? posn.decompress().calculate_score<Player::WHITE, NUM_ROWS, NUM_COLS, DEPTH + 1>()
-                    : posn.decompress().calculate_score<Player::BLACK, NUM_ROWS, NUM_COLS, DEPTH + 1>();
-            writer.write(posn, score);
-            if (++count % CHUNK_SIZE == 0) {
-                std::cout << "Evaluated " << count << " positions ("
-                          << 100 * (count / total) << "%)." << std::endl;
-            }
-        }
-        std::cout << "Evaluated " << count << " positions ("
-                  << 100 * (count / total) << "%)." << std::endl;
+        std::cout << "PLY " << ply << " POSITIONS " << reader.size()
+                  << std::endl;
+        dzc4::TableFileWriter writer(ply, reader.size());
+        evaluateply(ply, reader, writer, pool,
+                    [](dzc4::SolverKey posn, LookupCursor &) {
+            return ply % 2 == 0
+                ? posn.decompress().calculate_score<
+                        Player::WHITE, NUM_ROWS, NUM_COLS, DEPTH + 1>()
+                : posn.decompress().calculate_score<
+                        Player::BLACK, NUM_ROWS, NUM_COLS, DEPTH + 1>();
+        });
     }
     const std::string plyname = plyfilename(ply);
-    std::remove(plyname.c_str());
+    dzc4::exit_if(std::remove(plyname.c_str()) != 0,
+                  "ERROR: Failed to delete ply file ", plyname, ".");
 }
 
-void backstep(unsigned ply) {
+void backstep(unsigned ply, const std::string &table_name,
+              dzc4::ThreadPool &pool) {
     std::cout << "Back-propagating from ply " << ply
               << " to ply " << ply - 1 << "." << std::endl;
     {
         dzc4::DataFileReader reader(ply - 1);
-        double total = reader.size();
-        dzc4::TableFileWriter writer(ply - 1);
-        dzc4::MemoryMappedTable tabfile(tabfilename(ply));
-        // TODO: Check and handle file opening errors.
-        dzc4::CompressedPosition64 posn;
-        unsigned long long int count = 0;
-        while (reader >> posn) {
-            const int score = ply % 2 == 0
-                ? tabfile.evaluate<Player::BLACK, NUM_ROWS, NUM_COLS, DEPTH>(posn)
-                : tabfile.evaluate<Player::WHITE, NUM_ROWS, NUM_COLS, DEPTH>(posn);
-            writer.write(posn, score);
-            if (++count % CHUNK_SIZE == 0) {
-                std::cout << "Evaluated " << count << " positions ("
-                          << 100 * (count / total) << "%)." << std::endl;
-            }
-        }
-        std::cout << "Evaluated " << count << " positions ("
-                  << 100 * (count / total) << "%)." << std::endl;
+        std::cout << "PLY " << ply - 1 << " POSITIONS " << reader.size()
+                  << std::endl;
+        dzc4::TableFileWriter writer(ply - 1, reader.size());
+        const dzc4::MemoryMappedTable<BoardWord> tabfile(table_name);
+        tabfile.expect(NUM_ROWS, NUM_COLS, ply, DEPTH);
+        evaluateply(ply - 1, reader, writer, pool,
+                    [&](dzc4::SolverKey posn, LookupCursor &cursor) {
+            return ply % 2 == 0
+                ? tabfile.evaluate<Player::BLACK, NUM_ROWS, NUM_COLS, DEPTH>(
+                        posn, cursor)
+                : tabfile.evaluate<Player::WHITE, NUM_ROWS, NUM_COLS, DEPTH>(
+                        posn, cursor);
+        });
     }
     const std::string plyname = plyfilename(ply - 1);
-    std::remove(plyname.c_str());
+    dzc4::exit_if(std::remove(plyname.c_str()) != 0,
+                  "ERROR: Failed to delete ply file ", plyname, ".");
 }
 
 // ========================================================================== //
 // |||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||| //
 // ========================================================================== //
 
-int main() {
+// Returns true if chunkstep expands every position along the opening (see
+// expand above), which holds when the shallow evaluate<DEPTH> search leaves
+// each of them unresolved. Only then does a full solve contain the subtree
+// below the opening. An opening that passes up an immediate win, for one,
+// runs through a position that the full solve resolved without expanding it,
+// so none of the positions below it are in the full solve's tables.
+bool is_expanded(const std::string &opening) {
+    for (std::size_t ply = 1; ply <= opening.size(); ++ply) {
+        const dzc4::SolverPosition posn =
+            dzc4::play_opening(opening.substr(0, ply)).decompress();
+        const Evaluation ev = (ply % 2 == 0)
+            ? posn.evaluate_unwon<Player::WHITE, NUM_ROWS, NUM_COLS, DEPTH>()
+            : posn.evaluate_unwon<Player::BLACK, NUM_ROWS, NUM_COLS, DEPTH>();
+        if (ev != Evaluation::UNKNOWN) return false;
+    }
+    return true;
+}
 
-    dzc4::DataFileWriter(0) << dzc4::CompressedPosition64();
+// Returns the first ply, from root_ply on, for which a table from a full
+// solve of this board already exists, or 0 if there is none.
+unsigned find_full_table(unsigned root_ply) {
+    for (unsigned ply = root_ply; ply <= NUM_ROWS * NUM_COLS - DEPTH; ++ply) {
+        if (std::filesystem::exists(tabfilename(ply, ""))) return ply;
+    }
+    return 0;
+}
+
+// Prints the score of the root from the opening book, the tables with the
+// given tag, or a search (see PositionScorer.hpp).
+void print_root_score(dzc4::SolverKey root, unsigned root_ply,
+                      const std::string &tag) {
+    dzc4::PositionScorer scorer(tag);
+    std::cout << "ROOT SCORE " << (root_ply % 2 == 0
+            ? scorer.score<Player::WHITE>(root, root_ply)
+            : scorer.score<Player::BLACK>(root, root_ply)) << std::endl;
+}
 
-    for (unsigned ply = 0; ply < NUM_ROWS * NUM_COLS - DEPTH; ++ply) {
-        chunkstep(ply);
+// With no arguments, solves the whole board. Given an opening (see
+// Opening.hpp), solves only the subtree of positions reachable from it:
+// forward expansion starts at the ply of the opening, and all data files and
+// tables are tagged with the opening. If a full solve has already produced a
+// table for some later ply, expansion stops just short of it, and the first
+// backstep evaluates against that table instead of going all the way to the
+// end of the game. (Full tables are only used if the full solve expanded the
+// opening; see is_expanded.)
+int main(int argc, char **argv) {
+
+    dzc4::exit_if(argc > 2, "Usage: ", argv[0], " [OPENING]");
+    const std::string opening = (argc == 2) ? argv[1] : "";
+    const dzc4::SolverKey root = dzc4::play_opening(opening);
+    const unsigned root_ply = static_cast<unsigned>(opening.size());
+    constexpr unsigned last_ply = NUM_ROWS * NUM_COLS - DEPTH;
+    const bool reuse_full = !opening.empty() && is_expanded(opening);
+    const unsigned full_ply = reuse_full ? find_full_table(root_ply) : 0;
+    filename_tag = opening.empty() ? "" : "O" + opening;
+
+    // Positions at or beyond last_ply (and positions already in a full
+    // table) need no tables of their own.
+    if (!opening.empty() && (root_ply >= last_ply || full_ply == root_ply)) {
+        print_root_score(root, root_ply, "");
+        return EXIT_SUCCESS;
+    }
+
+    const unsigned stop_ply = full_ply ? full_ply - 1 : last_ply;
+    dzc4::ThreadPool pool(NUM_THREADS);
+    std::cout << "Scoring positions on " << pool.size() << " thread"
+              << (pool.size() == 1 ? "" : "s") << "." << std::endl;
+
+    dzc4::DataFileWriter(root_ply) << root;
+
+    for (unsigned ply = root_ply; ply < stop_ply; ++ply) {
+        {
+            dzc4::PhaseStats stats("chunkstep", ply);
+            chunkstep(ply);
+        }
+        dzc4::PhaseStats stats("mergestep", ply + 1);
         mergestep(ply + 1);
     }
 
-    endstep();
+    if (full_ply) {
+        dzc4::PhaseStats stats("backstep", full_ply);
+        backstep(full_ply, tabfilename(full_ply, ""), pool);
+    } else {
+        dzc4::PhaseStats stats("endstep", last_ply);
+        endstep(pool);
+    }
 
-    for (unsigned ply = NUM_ROWS * NUM_COLS - DEPTH; ply > 0; --ply) {
-        backstep(ply);
+    // Once the table of ply - 1 exists, the table of ply is only kept if ply
+    // is a multiple of TABLE_STRIDE (see SparseTables.hpp).
+    for (unsigned ply = stop_ply; ply > root_ply; --ply) {
+        dzc4::PhaseStats stats("backstep", ply);
+        backstep(ply, tabfilename(ply), pool);
+        if (ply % TABLE_STRIDE != 0) {
+            const std::string tabname = tabfilename(ply);
+            dzc4::exit_if(std::remove(tabname.c_str()) != 0,
+                          "ERROR: Failed to delete table file ", tabname, ".");
+        }
     }
 
+    // The root itself may have been pruned from its table.
+    print_root_score(root, root_ply, filename_tag);
+
     // for (unsigned ply = 3; ply > 0; --ply) {
     //     dzc4::MemoryMappedTable table(tabfilename(ply - 1));
     //     for (std::size_t i = 0; i < table.num_entries; ++i) {
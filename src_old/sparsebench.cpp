@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Constants.hpp"
+#include "FileNames.hpp"
+#include "MemoryMappedTable.hpp"
+#include "Position.hpp"
+#include "SparseTables.hpp"
+
+// Measures what a sparse solve (see TABLE_STRIDE) would save and cost, using
+// the tables of a full solve. SAMPLES entries are drawn at random from all
+// of the tables (each ply equally likely) and, for each stride k from 1 to
+// MAX_STRIDE, scored in random order through SparseTables as if only the
+// tables of plies that are multiples of k had been kept, starting from an
+// empty reconstruction cache. Each stride is summarized on one line:
+//
+//     STRIDE k TABLE_BYTES b PERCENT p MEAN_US m P99_US q MAX_US x
+//            CACHED c MISMATCHES n
+//
+// where p is b as a percentage of the size of all tables, the times are
+// latencies of single queries in microseconds, c is the number of scores in
+// the cache at the end, and n counts scores that differ from the full table
+// (which should never happen). SEED makes the sample repeatable.
+
+using dzc4::Player;
+
+constexpr unsigned LAST_PLY = NUM_ROWS * NUM_COLS - DEPTH;
+
+struct Sample {
+    unsigned ply;
+    dzc4::SolverKey posn;
+    int expected;
+};
+
+int main(int argc, char **argv) {
+
+    dzc4::exit_if(argc < 2 || argc > 4, "Usage: ", argv[0],
+                  " MAX_STRIDE [SAMPLES [SEED]]");
+    const unsigned max_stride = static_cast<unsigned>(std::stoul(argv[1]));
+    const std::size_t num_samples = (argc >= 3) ? std::stoull(argv[2]) : 10000;
+    const std::uint64_t seed = (argc >= 4) ? std::stoull(argv[3])
+                                           : std::random_device()();
+    dzc4::exit_if(max_stride == 0 || num_samples == 0,
+                  "ERROR: MAX_STRIDE and SAMPLES must be positive.");
+    std::mt19937_64 rng(seed);
+
+    const dzc4::SparseTables full;
+    std::vector<unsigned> plies;
+    for (unsigned ply = 0; ply <= LAST_PLY; ++ply) {
+        dzc4::exit_if(!full.is_stored(ply), "ERROR: Table ply ", ply,
+                      " is missing; sparsebench needs a full solve.");
+        if (full.table(ply)->num_entries > 0) plies.push_back(ply);
+    }
+
+    std::vector<Sample> samples;
+    std::uniform_int_distribution<std::size_t> pick_ply(0, plies.size() - 1);
+    for (std::size_t i = 0; i < num_samples; ++i) {
+        const unsigned ply = plies[pick_ply(rng)];
+        const dzc4::MemoryMappedTable<BoardWord> &table = *full.table(ply);
+        std::uniform_int_distribution<std::size_t> pick_index(
+                0, table.num_entries - 1);
+        const std::size_t index = pick_index(rng);
+        samples.push_back({ply, table.get_position(index),
+                           table.get_score(index)});
+    }
+    std::cout << "Sampled " << samples.size() << " entries with seed " << seed
+              << "." << std::endl;
+
+    for (unsigned stride = 1; stride <= max_stride; ++stride) {
+        const dzc4::SparseTables tables(stride);
+        dzc4::SparseTables::Cache cache(RECONSTRUCTION_CACHE_SIZE);
+        std::vector<double> latencies;
+        std::size_t mismatches = 0;
+        for (const Sample &sample : samples) {
+            const auto start_time = std::chrono::steady_clock::now();
+            const int score = sample.ply % 2 == 0
+                ? tables.score<Player::WHITE>(sample.posn, sample.ply, cache)
+                : tables.score<Player::BLACK>(sample.posn, sample.ply, cache);
+            const std::chrono::duration<double, std::micro> elapsed =
+                    std::chrono::steady_clock::now() - start_time;
+            latencies.push_back(elapsed.count());
+            if (score != sample.expected) ++mismatches;
+        }
+        std::sort(latencies.begin(), latencies.end());
+        double total = 0.0;
+        for (const double latency : latencies) total += latency;
+        std::cout << "STRIDE " << stride
+                  << " TABLE_BYTES " << tables.stored_bytes()
+                  << " PERCENT " << 100.0 * tables.stored_bytes()
+                                           / full.stored_bytes()
+                  << " MEAN_US " << total / latencies.size()
+                  << " P99_US " << latencies[latencies.size() * 99 / 100]
+                  << " MAX_US " << latencies.back()
+                  << " CACHED " << cache.size()
+                  << " MISMATCHES " << mismatches << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+
+}
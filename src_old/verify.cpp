@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Constants.hpp"
+#include "FileNames.hpp"
+#include "MemoryMappedTable.hpp"
+#include "PhaseStats.hpp"
+#include "Position.hpp"
+#include "SparseTables.hpp"
+#include "ThreadPool.hpp"
+
+// Checks that the tables produced by solver.cpp are consistent with one
+// another, without re-running the solve. Each entry of the ply n table is
+// re-scored from the ply n + 1 table by the same rules that backstep used
+// to write it (MemoryMappedTable::evaluate), and each entry of the last table
+// is re-scored by the search that endstep used. Keys must also be strictly
+// increasing, and the body checksum recorded in the header must match.
+// Tables of a sparse solve (see TABLE_STRIDE) are verified too: when the ply
+// n + 1 table was not kept, entries are re-scored by reconstruction from the
+// nearest later table (see SparseTables.hpp) instead. A ply that also has
+// a WDL table (see wdlconvert.cpp) must hold the same positions in it, and
+// MemoryMappedTable::lookup_wdl must give each of them the evaluation of
+// its score in the distance table.
+//
+// Given SAMPLES, only that many randomly chosen entries of each table are
+// re-scored (and the checksum, which would read every table in full, is
+// skipped), for a quick spot check. SEED makes the choice repeatable.
+
+using dzc4::Player;
+
+constexpr unsigned LAST_PLY = NUM_ROWS * NUM_COLS - DEPTH;
+constexpr std::size_t MAX_REPORTED_MISMATCHES = 10;
+
+using LookupCursor = dzc4::MemoryMappedTable<BoardWord>::LookupCursor;
+
+// Re-scores a position of the given ply from the next table, by a direct
+// search if posn belongs to the last table, or by reconstruction if the next
+// table was not kept. The cache is only created if it is needed.
+template <Player PLAYER>
+int rescore(const dzc4::SparseTables &tables, unsigned ply,
+            dzc4::SolverKey posn, LookupCursor &cursor,
+            std::optional<dzc4::SparseTables::Cache> &cache) {
+    if (ply == LAST_PLY) {
+        return posn.decompress().calculate_score<
+                PLAYER, NUM_ROWS, NUM_COLS, DEPTH + 1>();
+    }
+    if (const auto *next = tables.table(ply + 1)) {
+        return next->evaluate<PLAYER, NUM_ROWS, NUM_COLS, DEPTH>(posn, cursor);
+    }
+    if (!cache) cache.emplace(RECONSTRUCTION_CACHE_SIZE);
+    return tables.reconstruct<PLAYER>(posn, ply, *cache);
+}
+
+// Verifies the given entries of the ply table (all of them if indices is
+// empty) and returns the number of problems found.
+std::size_t verifyply(const dzc4::SparseTables &tables, unsigned ply,
+                      const std::vector<std::size_t> &indices,
+                      dzc4::ThreadPool &pool) {
+    const dzc4::MemoryMappedTable<BoardWord> &table = *tables.table(ply);
+    std::optional<dzc4::MemoryMappedTable<BoardWord>> wdl;
+    if (std::filesystem::exists(wdlfilename(ply))) {
+        wdl.emplace("", wdlfilename(ply));
+        wdl->expect(NUM_ROWS, NUM_COLS, ply, DEPTH);
+    }
+    const bool sampled = !indices.empty();
+    const std::size_t count = sampled ? indices.size() : table.num_entries;
+    std::cout << "Verifying " << count << " of " << table.num_entries
+              << " entries of table ply " << ply
+              << (wdl ? " and its WDL table" : "")
+              << (ply < LAST_PLY && !tables.is_stored(ply + 1)
+                  ? " by reconstruction." : ".") << std::endl;
+
+    std::atomic<std::size_t> num_problems = 0;
+    std::mutex report_mutex;
+    std::vector<std::pair<std::size_t, std::string>> reports;
+    const auto report = [&](std::size_t index, const std::string &problem) {
+        ++num_problems;
+        const std::lock_guard<std::mutex> lock(report_mutex);
+        if (reports.size() < MAX_REPORTED_MISMATCHES) {
+            reports.emplace_back(index, problem);
+        }
+    };
+
+    // Each thread takes contiguous ranges of entries, so the table being
+    // verified is read sequentially (and the next table mostly randomly).
+    for (std::size_t begin = 0; begin < count; begin += CHUNK_SIZE) {
+        const std::size_t end = std::min(begin + CHUNK_SIZE, count);
+        pool.parallel_for_ranges(begin, end, [&](std::size_t range_begin,
+                                                 std::size_t range_end) {
+            LookupCursor cursor;
+            std::optional<dzc4::SparseTables::Cache> cache;
+            for (std::size_t i = range_begin; i < range_end; ++i) {
+                const std::size_t index = sampled ? indices[i] : i;
+                const dzc4::SolverKey posn = table.get_position(index);
+                if (!sampled && index > 0
+                        && !(table.get_position(index - 1) < posn)) {
+                    report(index, "is out of order.");
+                }
+                const int stored = table.get_score(index);
+                const int expected = ply % 2 == 0
+                    ? rescore<Player::WHITE>(tables, ply, posn, cursor, cache)
+                    : rescore<Player::BLACK>(tables, ply, posn, cursor, cache);
+                if (stored != expected) {
+                    report(index, "has score " + std::to_string(stored)
+                                  + " but re-scores to "
+                                  + std::to_string(expected) + ".");
+                }
+                if (wdl && (ply % 2 == 0
+                        ? wdl->lookup_wdl<Player::WHITE, NUM_ROWS, NUM_COLS,
+                                          DEPTH>(posn)
+                        : wdl->lookup_wdl<Player::BLACK, NUM_ROWS, NUM_COLS,
+                                          DEPTH>(posn))
+                        != dzc4::score_to_evaluation(stored)) {
+                    report(index, "has a WDL evaluation that does not match "
+                                  "its score.");
+                }
+            }
+        });
+        if (end % CHUNK_SIZE == 0 && end != count) {
+            std::cout << "Verified " << end << " entries ("
+                      << 100 * (end / static_cast<double>(count)) << "%)."
+                      << std::endl;
+        }
+    }
+
+    std::sort(reports.begin(), reports.end());
+    for (const auto &[index, problem] : reports) {
+        std::cout << "MISMATCH ply " << ply << ": Entry " << index << ' '
+                  << problem << std::endl;
+    }
+    if (!sampled && !table.verify_checksum()) {
+        ++num_problems;
+        std::cout << "MISMATCH ply " << ply << ": Body checksum does not "
+                  << "match the header." << std::endl;
+    }
+    if (wdl && wdl->num_wdl_entries != table.num_entries) {
+        ++num_problems;
+        std::cout << "MISMATCH ply " << ply << ": WDL table has "
+                  << wdl->num_wdl_entries << " entries instead of "
+                  << table.num_entries << "." << std::endl;
+    }
+    if (wdl && !sampled && !wdl->verify_checksum()) {
+        ++num_problems;
+        std::cout << "MISMATCH ply " << ply << ": WDL body checksum does not "
+                  << "match the header." << std::endl;
+    }
+    std::cout << "PLY " << ply << " PROBLEMS " << num_problems << std::endl;
+    return num_problems;
+}
+
+int main(int argc, char **argv) {
+
+    dzc4::exit_if(argc > 3, "Usage: ", argv[0], " [SAMPLES [SEED]]");
+    const std::size_t samples = (argc >= 2) ? std::stoull(argv[1]) : 0;
+    const std::uint64_t seed = (argc >= 3) ? std::stoull(argv[2])
+                                           : std::random_device()();
+    if (samples) {
+        std::cout << "Sampling " << samples << " entries per table with seed "
+                  << seed << "." << std::endl;
+    }
+    std::mt19937_64 rng(seed);
+    dzc4::ThreadPool pool(NUM_THREADS);
+    const dzc4::SparseTables tables;
+
+    std::vector<unsigned> plies;
+    for (unsigned ply = 0; ply <= LAST_PLY; ++ply) {
+        if (tables.is_stored(ply)) plies.push_back(ply);
+    }
+    dzc4::exit_if(plies.empty(), "ERROR: Found no tables to verify.");
+
+    std::size_t num_problems = 0;
+    for (const unsigned ply : plies) {
+        std::vector<std::size_t> indices;
+        if (samples) {
+            const std::size_t num_entries = tables.table(ply)->num_entries;
+            if (num_entries == 0) continue;
+            std::uniform_int_distribution<std::size_t> pick(0, num_entries - 1);
+            for (std::size_t i = 0; i < samples; ++i) {
+                indices.push_back(pick(rng));
+            }
+            std::sort(indices.begin(), indices.end());
+            indices.erase(std::unique(indices.begin(), indices.end()),
+                          indices.end());
+        }
+        dzc4::PhaseStats stats("verify", ply);
+        num_problems += verifyply(tables, ply, indices, pool);
+    }
+
+    std::cout << "Verified " << plies.size() << " tables: " << num_problems
+              << " problems found." << std::endl;
+    return num_problems == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+
+}
@@ -0,0 +1,34 @@
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include "Constants.hpp"
+#include "FileNames.hpp"
+#include "Position.hpp"
+
+// Derives a compact WDL table (see MemoryMappedTable.hpp) from every distance
+// table produced by solver.cpp that does not already have one.
+
+void wdlstep(unsigned ply) {
+    std::cout << "Converting table for ply " << ply << " to WDL." << std::endl;
+    dzc4::TableFileReader reader(ply);
+    dzc4::WDLFileWriter writer(ply, reader.size(), reader.prune_depth());
+    dzc4::SolverKey posn;
+    int score;
+    while (reader.read(posn, score)) {
+        writer.write(posn, dzc4::score_to_evaluation(score));
+    }
+}
+
+int main() {
+
+    for (unsigned ply = 0; ply <= NUM_ROWS * NUM_COLS - DEPTH; ++ply) {
+        if (std::filesystem::exists(tabfilename(ply))
+            && !std::filesystem::exists(wdlfilename(ply))) {
+            wdlstep(ply);
+        }
+    }
+
+    return EXIT_SUCCESS;
+
+}